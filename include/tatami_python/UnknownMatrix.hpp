@@ -8,6 +8,9 @@
 #include "dense_extractor.hpp"
 #include "sparse_extractor.hpp"
 #include "parallelize.hpp"
+#include "ticks.hpp"
+#include "cache_budget.hpp"
+#include "orientation.hpp"
 
 #include <vector>
 #include <memory>
@@ -15,6 +18,9 @@
 #include <stdexcept>
 #include <optional>
 #include <cstddef>
+#include <limits>
+#include <chrono>
+#include <algorithm>
 
 /**
  * @file UnknownMatrix.hpp
@@ -36,8 +42,279 @@ struct UnknownMatrixOptions {
      * Whether to automatically enforce a minimum size for the cache, regardless of `maximum_cache_size`.
      * This minimum is chosen to ensure that all chunks overlapping one row (or a slice/subset thereof) can be retained in memory,
      * so that the same chunks are not repeatedly re-read from disk when iterating over consecutive rows/columns of the matrix.
+     * If `cache_budget` is set, this minimum is only enforced if it fits in the extractor's reservation.
      */
     bool require_minimum_cache = true;
+
+    /**
+     * Whether the backend for the matrix can be safely called from multiple threads at once.
+     * This is only relevant for free-threaded builds of CPython (PEP 703) when `TATAMI_PYTHON_PARALLELIZE_UNKNOWN` is defined, see `gil_disabled()` for details.
+     * If true, each thread will call `extract_dense_array()` and `extract_sparse_array()` concurrently via `attach()`.
+     * Otherwise, all calls are serialized via `TATAMI_PYTHON_SERIALIZE`, as if the GIL were still present.
+     * This option has no effect if the GIL is enabled, or if the application has defined its own `TATAMI_PYTHON_SERIALIZE`;
+     * in the latter case, all calls go through the application's macro, which is responsible for any serialization.
+     */
+    bool thread_safe = false;
+
+    /**
+     * Function to use in place of `delayedarray.extract_dense_array()`.
+     * This should accept the same arguments and return a NumPy array or any other object that can be parsed from `extract_dense_array()`.
+     * Users can supply their own function to change how the data is extracted without modifying the matrix itself,
+     * e.g., to distribute each request across a pool of worker processes that write into shared memory,
+     * which allows extraction to scale with the number of cores for backends that hold the GIL.
+     * If not set, `delayedarray.extract_dense_array()` is used.
+     */
+    std::optional<pybind11::object> dense_extractor;
+
+    /**
+     * Function to use in place of `delayedarray.extract_sparse_array()`.
+     * This should accept the same arguments and return a `SparseNdarray`.
+     * See `dense_extractor` for more details.
+     * If not set, `delayedarray.extract_sparse_array()` is used.
+     */
+    std::optional<pybind11::object> sparse_extractor;
+
+    /**
+     * A Python executor from the `concurrent.futures` module, e.g., a `ThreadPoolExecutor`.
+     * If set, oracle-aware extractors will split each batch of chunks into groups that are submitted to the executor via `submit()`,
+     * such that multiple calls to `extract_dense_array()` or `extract_sparse_array()` are in flight at once.
+     * This allows backends that release the GIL during I/O (e.g., **h5py**, **zarr**) to overlap their reads,
+     * as the GIL is released while waiting for the result of each submission.
+     * If not set, each batch of chunks is extracted with a single call in the current thread.
+     */
+    std::optional<pybind11::object> executor;
+
+    /**
+     * An **asyncio** event loop that is running in a separate thread.
+     * If set, the extraction functions (i.e., `dense_extractor` and `sparse_extractor`) are assumed to return awaitables,
+     * which are scheduled on this loop via `asyncio.run_coroutine_threadsafe()`.
+     * Oracle-aware extractors will keep up to `max_in_flight` requests outstanding on the loop for each batch of chunks.
+     * This takes precedence over `executor`.
+     */
+    std::optional<pybind11::object> event_loop;
+
+    /**
+     * Maximum number of calls to submit to `executor` or `event_loop` for each batch of chunks, i.e., the prefetch depth.
+     * Larger values increase the overlap between calls at the cost of more (and smaller) calls into Python.
+     * Only used if `executor` or `event_loop` is set.
+     */
+    std::size_t max_in_flight = 4;
+
+    /**
+     * Whether to pass a writable NumPy view of the cache to the dense extraction function via an `out=` keyword argument.
+     * The view has the same dtype as `CachedValue_` and the same shape as the requested submatrix,
+     * and is C-contiguous when extracting rows and F-contiguous when extracting columns.
+     * Backends that support this protocol (e.g., via **h5py**'s `read_direct()` or NumPy's `take(out=)`) can then fill the cache directly without any intermediate allocation or copy.
+     * Support for `out=` is detected once in the `UnknownMatrix` constructor, and the usual extraction is used if the function does not support it.
+     * The function is assumed to support `out=` if it has a `supports_out` attribute that is truthy;
+     * or, if no such attribute exists, its signature (from `inspect.signature()`) contains an `out` parameter or accepts arbitrary keyword arguments.
+     * If the backend returns a different array, its contents are copied into the cache as usual.
+     * The view should not be retained by the backend after the call, as the underlying memory is owned by the cache.
+     *
+     * This is only used for oracle-aware extractors when a single chunk is requested at a time, as different chunks are stored in non-contiguous memory.
+     * It is also ignored if `event_loop` is set.
+     */
+    bool use_out = false;
+
+    /**
+     * Function to extract multiple chunks from the matrix in a single call, for use by oracle-aware extractors.
+     * This should accept four arguments:
+     * - `x`, the matrix.
+     * - `ranges`, a list of `(start, length)` tuples specifying contiguous ranges along the target dimension.
+     *   Each range corresponds to a chunk, and ranges are sorted and non-overlapping.
+     * - `non_target`, a NumPy array of sorted and unique indices along the other dimension.
+     * - `axis`, an integer specifying the target dimension, i.e., 0 for rows and 1 for columns.
+     * .
+     * It should return a list of NumPy arrays, one per range, each containing the contents of the submatrix for that range and `non_target`.
+     * Alternatively, it may return a single NumPy array containing the concatenation of the submatrices along the target dimension.
+     * This allows backends to read each range with an efficient contiguous selection (e.g., a hyperslab in HDF5),
+     * rather than rediscovering the chunk structure from the concatenated indices passed to `extract_dense_array()`.
+     * If not set, oracle-aware extractors will use the dense extraction function with the concatenated indices.
+     */
+    std::optional<pybind11::object> dense_chunk_extractor;
+
+    /**
+     * Function to extract multiple chunks from the matrix in a single call, for use by oracle-aware extractors.
+     * This should accept the same arguments as `dense_chunk_extractor` and return a list of `SparseNdarray`s, one per range, or a single concatenated `SparseNdarray`.
+     * If not set, oracle-aware extractors will use the sparse extraction function with the concatenated indices.
+     */
+    std::optional<pybind11::object> sparse_chunk_extractor;
+
+    /**
+     * Minimum number of elements to extract in each call to Python, see `merge_chunk_ticks()` for details.
+     * If positive, adjacent chunks along each dimension are merged into virtual super-chunks that contain at least this many elements when the full extent of the other dimension is extracted.
+     * This amortizes the overhead of each Python call when the chunks reported by `chunk_grid()` are very small, e.g., one row at a time.
+     * Each super-chunk is also capped so that it fits within `maximum_cache_size`.
+     * The super-chunks are reported by `UnknownMatrix::chunk_ticks()`.
+     * This has no effect if `maximum_cache_size` is zero.
+     */
+    std::size_t minimum_chunk_elements = 0;
+
+    /**
+     * Whether to split chunks that are too large to fit into the cache, see `split_chunk_ticks()` for details.
+     * Each chunk is split along the target dimension so that a single sub-chunk (spanning the full extent of the other dimension) fits within `maximum_cache_size`.
+     * This ensures that memory usage remains bounded for matrices with very large chunks,
+     * without resorting to a separate Python call for each row/column when `require_minimum_cache = false`.
+     * The sub-chunks are reported by `UnknownMatrix::chunk_ticks()`.
+     * As these are no longer aligned to the chunks of the underlying storage, `parallelize_chunks()` and `parallelize_stealing()` may then assign parts of the same chunk to different threads,
+     * such that the chunk is read more than once; this option is therefore disabled by default.
+     * This has no effect if `maximum_cache_size` is zero.
+     */
+    bool split_oversized_chunks = false;
+
+    /**
+     * Whether myopic extractors should adapt the granularity of each Python call to the observed access pattern.
+     * By default, myopic extractors always fetch the entire chunk containing the requested row/column.
+     * If this is true, each extractor tracks how often its loaded chunks are reused.
+     * If most requests require a new chunk to be loaded (e.g., random access), the extractor switches to fetching individual rows/columns instead.
+     * It switches back to whole-chunk fetching once the recent requests would have been mostly served from the cache.
+     * The number of switches is reported in `UnknownMatrixStatistics`.
+     */
+    bool adaptive_granularity = false;
+
+    /**
+     * Whether myopic extractors should detect sequential access and read ahead.
+     * If this is true, each myopic extractor checks whether its requests follow a constant stride along the target dimension, e.g., consecutive rows.
+     * After a few such requests, the extractor predicts the rest of the sequence and behaves like an oracle-aware extractor,
+     * i.e., upcoming chunks are batched into a single Python call (or multiple in-flight calls, see `executor`).
+     * It reverts to the usual myopic behavior as soon as a request deviates from the predicted sequence.
+     * The read-ahead cache is taken from the myopic cache, so `maximum_cache_size` is split evenly between the two caches of each myopic extractor.
+     * This only occurs if each half can hold at least two chunks; otherwise, the myopic extractor keeps the entire cache and does not read ahead.
+     * Predictions only extend as far as the read-ahead cache can hold, and the switch is deferred until the sequence leaves the chunk in the myopic cache, so no chunk is fetched twice.
+     * The number of switches is reported in `UnknownMatrixStatistics`.
+     */
+    bool sequential_read_ahead = true;
+
+    /**
+     * Eviction policy for the cache used by myopic extractors.
+     * The default LRU policy is best for consecutive access, while `CachePolicy::TWO_QUEUE` and `CachePolicy::LFU` are more resistant to repeated scans that are larger than the cache.
+     * This has no effect on oracle-aware extractors, which always evict the slabs that are not needed for upcoming predictions.
+     */
+    CachePolicy cache_policy = CachePolicy::LRU;
+
+    /**
+     * Whether to record each chunk access by the extractors, see `UnknownMatrix::access_trace()`.
+     * The trace can be replayed offline against a range of cache sizes to choose `maximum_cache_size`, e.g., with `tools/cache_advisor.py`.
+     * This incurs a lock and an allocation for each access, so it should only be enabled for profiling.
+     */
+    bool record_trace = false;
+
+    /**
+     * Byte budget to be shared across all extractors, possibly from multiple `UnknownMatrix` instances, see `CacheBudget` for details.
+     * If set, each extractor reserves its cache from this budget instead of using `maximum_cache_size`,
+     * which is instead used as an upper bound on the demand of each extractor.
+     * For myopic extractors with `sequential_read_ahead = true`, the demand is doubled and the reservation is split evenly between the myopic and read-ahead caches, see `sequential_read_ahead` for details.
+     * The budget is never exceeded, even if `require_minimum_cache = true` or `minimum_batch_elements` is positive;
+     * these only increase the demand of each extractor, which will use a smaller cache (or none at all) if its reservation is not large enough.
+     */
+    std::shared_ptr<CacheBudget> cache_budget;
+
+    /**
+     * Limit on the memory used by all extractors of the matrix, in bytes, see `UnknownMatrixStatistics::current_memory` for details.
+     * If the results of a batch of chunks would exceed this limit, oracle-aware extractors (and the read-ahead caches of myopic extractors, see `sequential_read_ahead`) will split the batch into multiple smaller calls to Python.
+     * This is not a hard cap, as it only applies to the splitting of these batches.
+     * Each call contains at least one chunk, which cannot be split, so the limit may still be exceeded if a single chunk does not fit or the memory used by the caches already exceeds the limit.
+     * Myopic extractors only fetch a single chunk (or row/column) in each call, so their calls are never affected by this limit.
+     * Note that this limit does not affect the size of the cache, which should be controlled with `maximum_cache_size` or `cache_budget`.
+     * If zero, no limit is imposed.
+     */
+    std::size_t memory_limit = 0;
+
+    /**
+     * Maximum number of elements in the staging buffers of each oracle-aware sparse extractor for row extraction.
+     * These buffers hold the values and indices of each column of a `SparseNdarray` returned by Python, so they must be as long as the number of rows in each call.
+     * By default, they are sized to the number of rows in the largest batch that fits in the cache.
+     * If this is positive, the buffers are capped at this length (or the length of the longest chunk, if greater),
+     * and batches that span more rows are split into multiple calls to Python.
+     * This has no effect on column extraction, where each buffer only needs to be as long as the number of extracted rows.
+     */
+    std::size_t maximum_staging_elements = 0;
+
+    /**
+     * Minimum number of elements to extract in each call to Python by oracle-aware extractors.
+     * Each batch of chunks is extracted when the extractor runs out of predicted rows/columns in its cache,
+     * so the size of each batch is limited by the number of slabs in the cache.
+     * If this is positive, the cache of each oracle-aware extractor is enlarged so that it can hold at least this many elements (or all chunks, if fewer),
+     * such that each refill can request this many elements at once, even if `maximum_cache_size` is small.
+     * The same applies to the read-ahead cache of myopic extractors when `sequential_read_ahead = true`.
+     * Note that a refill only requests the chunks that are missing from the cache, as chunks that are already cached (and still needed) are never fetched again;
+     * so a refill may request fewer elements than this minimum if some of the upcoming chunks are already in the cache.
+     * Without a `cache_budget`, the enlarged cache may exceed `maximum_cache_size`.
+     * If `cache_budget` is set, the cache is not enlarged after the reservation is made;
+     * instead, this minimum is folded into each extractor's demand from the budget, and the cache is limited to whatever is reserved.
+     * This has no effect on extractors that do not have a cache, i.e., when `maximum_cache_size = 0` and `require_minimum_cache = false`.
+     */
+    std::size_t minimum_batch_elements = 0;
+
+    /**
+     * Maximum number of elements to extract in each call to Python by oracle-aware extractors.
+     * If positive, each batch of chunks is split into multiple calls that each contain no more than this number of elements,
+     * which avoids the creation of very large temporary NumPy arrays.
+     * Each call contains at least one chunk, so this limit may be exceeded for large chunks.
+     */
+    std::size_t maximum_batch_elements = 0;
+
+    /**
+     * Costs used to choose the preferred dimension for iteration, see `estimate_fetch_cost()` for details.
+     * The cost of fetching a single row or column is estimated from the chunk boundaries reported by `chunk_grid()`, the extent of the other dimension and the sparsity of the matrix.
+     * `UnknownMatrix::prefer_rows_proportion()` then reports the fraction of the combined cost that is attributable to columns.
+     */
+    OrientationCosts orientation_costs;
+
+    /**
+     * Whether to time the extraction of a chunk in each dimension during construction of the `UnknownMatrix`.
+     * If true, the cost of each dimension is set to the fastest of two calls to Python that extract the middle row (or column) across the full extent of the other dimension.
+     * This replaces the estimates from `orientation_costs`, which may be inaccurate for backends with unusual access costs, e.g., remote stores.
+     * The probe is only performed once and does not populate any caches.
+     * This cannot be used with `event_loop`, as the probe would block on the event loop during construction;
+     * an error is raised in that case.
+     */
+    bool probe_orientation = false;
+};
+
+/**
+ * @brief Statistics for data extraction from an `UnknownMatrix`.
+ *
+ * These are aggregated across all extractors created from the same `UnknownMatrix`.
+ */
+struct UnknownMatrixStatistics {
+    /**
+     * Number of chunks that were loaded into the cache.
+     */
+    std::size_t chunk_loads = 0;
+
+    /**
+     * Number of individual rows/columns that were fetched without caching their chunks, see `UnknownMatrixOptions::adaptive_granularity`.
+     */
+    std::size_t element_loads = 0;
+
+    /**
+     * Number of times that a myopic extractor switched from whole-chunk fetching to fetching individual rows/columns.
+     */
+    std::size_t switches_to_element = 0;
+
+    /**
+     * Number of times that a myopic extractor switched from fetching individual rows/columns to whole-chunk fetching.
+     */
+    std::size_t switches_to_chunk = 0;
+
+    /**
+     * Number of times that a myopic extractor detected sequential access and started reading ahead, see `UnknownMatrixOptions::sequential_read_ahead`.
+     */
+    std::size_t switches_to_read_ahead = 0;
+
+    /**
+     * Number of bytes currently held by all extractors.
+     * This includes the slab caches, the staging buffers, the NumPy arrays containing the indices of the non-target dimension,
+     * and the results of any calls to Python that are currently in flight.
+     * Results are accounted for by the size of the slabs that they populate, which is an upper bound for sparse matrices.
+     */
+    std::size_t current_memory = 0;
+
+    /**
+     * Maximum value of `current_memory` since the construction of the matrix or the last call to `UnknownMatrix::reset_peak_memory()`.
+     */
+    std::size_t peak_memory = 0;
 };
 
 /**
@@ -65,15 +342,44 @@ public:
     UnknownMatrix(pybind11::object seed, const UnknownMatrixOptions& opt) : 
         my_seed(std::move(seed)), 
         my_module(pybind11::module::import("delayedarray")),
-        my_dense_extractor(my_module.attr("extract_dense_array")),
-        my_sparse_extractor(my_module.attr("extract_sparse_array")),
+        my_dense_extractor(opt.dense_extractor.has_value() ? *(opt.dense_extractor) : pybind11::object(my_module.attr("extract_dense_array"))),
+        my_sparse_extractor(opt.sparse_extractor.has_value() ? *(opt.sparse_extractor) : pybind11::object(my_module.attr("extract_sparse_array"))),
         my_cache_size_in_bytes(opt.maximum_cache_size),
-        my_require_minimum_cache(opt.require_minimum_cache)
+        my_require_minimum_cache(opt.require_minimum_cache),
+        my_cache_budget(opt.cache_budget),
+        my_minimum_batch_elements(opt.minimum_batch_elements)
     {
         // We assume the constructor only occurs on the main thread, so we
         // won't bother locking things up. I'm also not sure that the
         // operations in the initialization list are thread-safe.
 
+        my_core_options.thread_safe = opt.thread_safe;
+        my_core_options.executor = opt.executor;
+        my_core_options.max_in_flight = opt.max_in_flight;
+        my_core_options.use_out = opt.use_out && accepts_out_argument(my_dense_extractor);
+        my_core_options.dense_chunk_extractor = opt.dense_chunk_extractor;
+        my_core_options.sparse_chunk_extractor = opt.sparse_chunk_extractor;
+        my_core_options.adaptive_granularity = opt.adaptive_granularity;
+        my_core_options.read_ahead = opt.sequential_read_ahead;
+        my_core_options.cache_policy = opt.cache_policy;
+        my_core_options.memory.set_limit(opt.memory_limit);
+        my_core_options.maximum_staging_elements = opt.maximum_staging_elements;
+        my_core_options.maximum_batch_elements = opt.maximum_batch_elements;
+        if (!opt.cache_budget) {
+            // Otherwise, the minimum batch size is folded into each extractor's demand from the budget, see reserve_cache().
+            my_core_options.minimum_batch_elements = opt.minimum_batch_elements;
+        }
+        if (opt.record_trace) {
+            my_core_options.trace.reset(new AccessTrace);
+        }
+        if (opt.event_loop.has_value()) {
+            my_core_options.event_loop = opt.event_loop;
+            my_core_options.run_coroutine = pybind11::module::import("asyncio").attr("run_coroutine_threadsafe");
+        }
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+        gil_disabled(); // caching the result while we're still in a serial context.
+#endif
+
         const auto shape = get_shape<Index_>(my_seed);
         my_nrow = shape.first;
         my_ncol = shape.second;
@@ -94,7 +400,7 @@ public:
 
         auto np = pybind11::module::import("numpy");
         auto arrayfun = np.attr("array");
-        auto populate = [&](Index_ extent, const pybind11::object& raw_ticks, std::vector<Index_>& map, std::vector<Index_>& new_ticks, Index_& max_chunk_size) {
+        auto populate = [&](Index_ extent, const pybind11::object& raw_ticks, std::vector<Index_>& new_ticks) {
             // Force realization of Iterable into a numpy array on the Python side.
             // Assume that casting to Index_ is safe, given that we were able to cast the extent.
             auto tick_array = arrayfun(raw_ticks, pybind11::dtype::of<Index_>());
@@ -104,10 +410,6 @@ public:
 
             new_ticks.reserve(sanisizer::sum<decltype(new_ticks.size())>(nticks, 1));
             new_ticks.push_back(0);
-            tatami::resize_container_to_Index_size(map, extent);
-            Index_ counter = 0;
-            max_chunk_size = 0;
-
             for (I<decltype(nticks)> i = 0; i < nticks; ++i) {
                 const auto latest = tptr[i];
                 const auto previous = new_ticks.back();
@@ -116,13 +418,6 @@ public:
                     throw std::runtime_error("boundaries are not strictly increasing in the output of 'chunk_grid(<" + ctype + ">).boundaries'");
                 }
                 new_ticks.push_back(latest);
-
-                std::fill(map.begin() + previous, map.begin() + latest, counter);
-                ++counter;
-                const auto to_fill = latest - previous;
-                if (to_fill > max_chunk_size) {
-                    max_chunk_size = to_fill;
-                }
             }
 
             if (!sanisizer::is_equal(new_ticks.back(), extent)) {
@@ -131,20 +426,112 @@ public:
             }
         };
 
-        populate(my_nrow, bounds[0], my_row_chunk_map, my_row_chunk_ticks, my_row_max_chunk_size);
-        populate(my_ncol, bounds[1], my_col_chunk_map, my_col_chunk_ticks, my_col_max_chunk_size);
+        populate(my_nrow, bounds[0], my_row_chunk_ticks);
+        populate(my_ncol, bounds[1], my_col_chunk_ticks);
+
+        // Choose the dimension that is cheaper to fetch from a cold cache.
+        // For dense matrices with regular chunks, this is the dimension that requires pulling out fewer chunks for each row/column.
+        // This does not hold for sparse matrices, where each call also pays for one SparseNdarray leaf per column of the extracted submatrix;
+        // this favors columns, as a row's leaves scale with the number of columns while a column's leaves only scale with its chunk length.
+        const std::size_t element_size = sizeof(CachedValue_) + (my_sparse ? sizeof(CachedIndex_) : 0);
+        double row_cost, col_cost;
+        if (opt.probe_orientation && my_nrow > 0 && my_ncol > 0) {
+            // The probe would block on the event loop, which deadlocks if the constructor is itself running on the loop's thread.
+            if (my_core_options.event_loop.has_value()) {
+                throw std::runtime_error("'probe_orientation' cannot be used with 'event_loop', as the probe would block on the event loop during construction");
+            }
+            row_cost = probe_fetch_cost(true);
+            col_cost = probe_fetch_cost(false);
+        } else {
+            row_cost = estimate_fetch_cost(opt.orientation_costs, my_row_chunk_ticks, my_ncol, true, element_size, my_sparse);
+            col_cost = estimate_fetch_cost(opt.orientation_costs, my_col_chunk_ticks, my_nrow, false, element_size, my_sparse);
+        }
+        my_prefer_rows_proportion = orientation_proportion(row_cost, col_cost);
+        my_prefer_rows = row_cost <= col_cost;
+
+        // Adjusting the chunks after choosing the preferred dimension, as the adjusted chunks do not reflect the storage layout.
+        // We assume that the full extent of the other dimension is extracted when deciding whether a chunk fits in the cache.
+        auto max_chunk_length = [&](const Index_ non_target_extent) -> std::size_t {
+            const std::size_t bytes_per_element = sanisizer::product<std::size_t>(element_size, non_target_extent);
+            return my_cache_size_in_bytes / bytes_per_element;
+        };
+
+        if (opt.minimum_chunk_elements > 0 && my_cache_size_in_bytes > 0) {
+            auto merge = [&](std::vector<Index_>& ticks, const Index_ non_target_extent) -> void {
+                if (non_target_extent == 0) {
+                    return;
+                }
+                const auto extent = ticks.back();
+                const std::size_t min_length = opt.minimum_chunk_elements / static_cast<std::size_t>(non_target_extent) + (opt.minimum_chunk_elements % static_cast<std::size_t>(non_target_extent) > 0);
+                const std::size_t max_length = max_chunk_length(non_target_extent);
+                ticks = merge_chunk_ticks(
+                    ticks,
+                    static_cast<Index_>(std::min(min_length, static_cast<std::size_t>(extent))), // casts are safe as we cap them at the extent.
+                    static_cast<Index_>(std::min(max_length, static_cast<std::size_t>(extent)))
+                );
+            };
+            merge(my_row_chunk_ticks, my_ncol);
+            merge(my_col_chunk_ticks, my_nrow);
+        }
+
+        if (opt.split_oversized_chunks && my_cache_size_in_bytes > 0) {
+            auto split = [&](std::vector<Index_>& ticks, const Index_ non_target_extent) -> void {
+                if (non_target_extent == 0) {
+                    return;
+                }
+                const std::size_t max_length = std::max(max_chunk_length(non_target_extent), static_cast<std::size_t>(1));
+                if (sanisizer::is_less_than(max_length, ticks.back())) {
+                    ticks = split_chunk_ticks(ticks, static_cast<Index_>(max_length)); // cast is safe as it is less than the extent.
+                }
+            };
+            split(my_row_chunk_ticks, my_ncol);
+            split(my_col_chunk_ticks, my_nrow);
+        }
 
-        // Choose the dimension that requires pulling out fewer chunks.
-        auto chunks_per_row = my_col_chunk_ticks.size() - 1;
-        auto chunks_per_col = my_row_chunk_ticks.size() - 1;
-        my_prefer_rows = chunks_per_row <= chunks_per_col;
+        auto finalize = [&](const std::vector<Index_>& ticks, ChunkLookup<Index_>& lookup, Index_& max_chunk_size) -> void {
+            lookup = ChunkLookup<Index_>(ticks);
+            max_chunk_size = 0;
+            for (I<decltype(ticks.size())> i = 1, end = ticks.size(); i < end; ++i) {
+                const auto length = ticks[i] - ticks[i - 1];
+                if (length > max_chunk_size) {
+                    max_chunk_size = length;
+                }
+            }
+        };
+
+        finalize(my_row_chunk_ticks, my_row_chunk_map, my_row_max_chunk_size);
+        finalize(my_col_chunk_ticks, my_col_chunk_map, my_col_max_chunk_size);
     }
 
 private:
     Index_ my_nrow, my_ncol;
     bool my_sparse, my_prefer_rows;
+    double my_prefer_rows_proportion;
+
+    // Time taken to extract the middle row/column, in nanoseconds.
+    // The backend still has to read each chunk containing this row/column, so this captures the read amplification of the chunk layout,
+    // without the cost of transferring the rest of the chunk into Python (which would not be representative of a cached extractor anyway).
+    double probe_fetch_cost(const bool row) const {
+        const Index_ extent = (row ? my_nrow : my_ncol);
+        const Index_ non_target_extent = (row ? my_ncol : my_nrow);
+
+        pybind11::tuple args(2);
+        args[static_cast<int>(!row)] = create_indexing_array<Index_>(extent / 2, 1);
+        args[static_cast<int>(row)] = create_indexing_array<Index_>(0, non_target_extent);
+        const auto& extractor = (my_sparse ? my_sparse_extractor : my_dense_extractor);
+
+        // Taking the faster of two calls, as the first call may include one-off costs like opening a file.
+        double output = std::numeric_limits<double>::infinity();
+        for (int rep = 0; rep < 2; ++rep) {
+            const auto begin = std::chrono::steady_clock::now();
+            call_extractor(extractor, my_seed, my_core_options, args);
+            const auto end = std::chrono::steady_clock::now();
+            output = std::min(output, std::chrono::duration<double, std::nano>(end - begin).count());
+        }
+        return output;
+    }
 
-    std::vector<Index_> my_row_chunk_map, my_col_chunk_map;
+    ChunkLookup<Index_> my_row_chunk_map, my_col_chunk_map;
     std::vector<Index_> my_row_chunk_ticks, my_col_chunk_ticks;
 
     // To decide how many chunks to store in the cache, we pretend the largest
@@ -163,6 +550,10 @@ private:
 
     std::size_t my_cache_size_in_bytes;
     bool my_require_minimum_cache;
+    std::shared_ptr<CacheBudget> my_cache_budget;
+    std::size_t my_minimum_batch_elements;
+
+    CoreOptions my_core_options;
 
 public:
     Index_ nrow() const {
@@ -186,13 +577,76 @@ public:
     }
 
     double prefer_rows_proportion() const {
-        return static_cast<double>(my_prefer_rows);
+        return my_prefer_rows_proportion;
     }
 
     bool uses_oracle(bool) const {
         return true;
     }
 
+    /**
+     * @param row Whether to return the chunk boundaries along the rows.
+     * If false, the boundaries along the columns are returned instead.
+     * @return Vector of chunk boundaries, starting at zero and ending at the number of rows (or columns).
+     * The `i`-th chunk starts at the `i`-th entry and ends before the `i + 1`-th entry.
+     * This can be used with `partition_chunks()` to create chunk-aligned ranges for parallel iteration.
+     * Note that these boundaries may be different from those reported by `chunk_grid()`, e.g., if `UnknownMatrixOptions::minimum_chunk_elements` is positive.
+     */
+    const std::vector<Index_>& chunk_ticks(bool row) const {
+        if (row) {
+            return my_row_chunk_ticks;
+        } else {
+            return my_col_chunk_ticks;
+        }
+    }
+
+    /**
+     * @return Statistics for data extraction from this matrix, aggregated across all of its extractors.
+     * This is safe to call while extractors are in use in other threads, though the counts may not be fully up to date.
+     */
+    UnknownMatrixStatistics statistics() const {
+        UnknownMatrixStatistics output;
+        const auto& counters = my_core_options.counters;
+        output.chunk_loads = counters.chunk_loads.load(std::memory_order_relaxed);
+        output.element_loads = counters.element_loads.load(std::memory_order_relaxed);
+        output.switches_to_element = counters.switches_to_element.load(std::memory_order_relaxed);
+        output.switches_to_chunk = counters.switches_to_chunk.load(std::memory_order_relaxed);
+        output.switches_to_read_ahead = counters.switches_to_read_ahead.load(std::memory_order_relaxed);
+        output.current_memory = my_core_options.memory.current();
+        output.peak_memory = my_core_options.memory.peak();
+        return output;
+    }
+
+    /**
+     * Reset `UnknownMatrixStatistics::peak_memory` to the current memory usage, e.g., to measure the peak for a single pass through the matrix.
+     */
+    void reset_peak_memory() const {
+        my_core_options.memory.reset_peak();
+    }
+
+    /**
+     * @return All chunk accesses by extractors for this matrix, in the order in which they were made by each extractor.
+     * Accesses from different threads are interleaved.
+     * This is empty if `UnknownMatrixOptions::record_trace` is false.
+     * The records can be saved with `write_access_trace()` for replay with `tools/cache_advisor.py`.
+     */
+    std::vector<AccessRecord> access_trace() const {
+        if (my_core_options.trace) {
+            return my_core_options.trace->records();
+        } else {
+            return std::vector<AccessRecord>();
+        }
+    }
+
+    /**
+     * Clear the recorded chunk accesses, e.g., to ignore the accesses from a warm-up step.
+     */
+    void clear_access_trace() const {
+        if (my_core_options.trace) {
+            my_core_options.trace->clear();
+        }
+    }
+
 private:
     Index_ max_primary_chunk_length(bool row) const {
         return (row ? my_row_max_chunk_size : my_col_max_chunk_size);
@@ -211,20 +665,49 @@ private:
         return (row ? my_ncol : my_nrow);
     }
 
-    const std::vector<Index_>& chunk_ticks(bool row) const {
+    const ChunkLookup<Index_>& chunk_map(bool row) const {
         if (row) {
-            return my_row_chunk_ticks;
+            return my_row_chunk_map;
         } else {
-            return my_col_chunk_ticks;
+            return my_col_chunk_map;
         }
     }
 
-    const std::vector<Index_>& chunk_map(bool row) const {
-        if (row) {
-            return my_row_chunk_map;
-        } else {
-            return my_col_chunk_map;
+    // Reserves the cache for a new extractor from the shared budget, if any, and returns the cache size to use.
+    std::size_t reserve_cache(bool row, Index_ non_target_length, std::size_t element_size, bool oracle, CacheBudget::Reservation& reservation) const {
+        if (!my_cache_budget) {
+            return my_cache_size_in_bytes;
+        }
+
+        // Demand is capped at the size of the entire target dimension, as we'll never need more than that.
+        std::size_t demand = my_cache_size_in_bytes;
+        const std::size_t per_target = element_size * static_cast<std::size_t>(non_target_length);
+        const std::size_t extent = (row ? my_nrow : my_ncol);
+        if (per_target == 0 || extent <= demand / per_target) {
+            demand = per_target * extent;
         }
+
+        // The minimum cache size and batch size are folded into the demand, as they are not enforced beyond the reservation.
+        // This ensures that the budget is never exceeded, even if there are more active extractors than expected.
+        const Index_ max_target_chunk_length = max_primary_chunk_length(row);
+        const std::size_t per_slab = per_target * static_cast<std::size_t>(max_target_chunk_length);
+        if (per_slab > 0) {
+            std::size_t minimum_slabs = my_require_minimum_cache;
+            if ((oracle || my_core_options.read_ahead) && my_minimum_batch_elements > 0) {
+                const std::size_t slab_elements = per_slab / element_size;
+                const std::size_t needed = my_minimum_batch_elements / slab_elements + (my_minimum_batch_elements % slab_elements > 0);
+                minimum_slabs = std::max(minimum_slabs, std::min(needed, static_cast<std::size_t>(primary_num_chunks(row, max_target_chunk_length))));
+            }
+            const std::size_t minimum = (minimum_slabs > std::numeric_limits<std::size_t>::max() / per_slab ? std::numeric_limits<std::size_t>::max() : minimum_slabs * per_slab);
+            demand = std::max(demand, minimum);
+        }
+
+        // Myopic extractors may take a read-ahead cache out of their own cache, so they ask for enough to hold both.
+        const std::size_t num_caches = (!oracle && my_core_options.read_ahead ? 2 : 1);
+        demand = (demand > std::numeric_limits<std::size_t>::max() / num_caches ? std::numeric_limits<std::size_t>::max() : demand * num_caches);
+
+        reservation = my_cache_budget->reserve(demand);
+        return reservation.bytes();
     }
 
     /********************
@@ -243,15 +726,25 @@ private:
         tatami::MaybeOracle<oracle_, Index_> oracle,
         Args_&& ... args
     ) const {
+        CacheBudget::Reservation reservation;
+        const auto cache_size = reserve_cache(row, non_target_length, sizeof(CachedValue_), oracle_, reservation);
+
         Index_ max_target_chunk_length = max_primary_chunk_length(row);
         tatami_chunked::SlabCacheStats<Index_> stats(
             /* target length = */ max_target_chunk_length,
             /* non_target_length = */ non_target_length,
             /* target_num_slabs = */ primary_num_chunks(row, max_target_chunk_length),
-            /* cache_size_in_bytes = */ my_cache_size_in_bytes,
+            /* cache_size_in_bytes = */ cache_size,
             /* element_size = */ sizeof(CachedValue_),
-            /* require_minimum_cache = */ my_require_minimum_cache
+            /* require_minimum_cache = */ my_require_minimum_cache && !my_cache_budget
         );
+        if constexpr(oracle_) {
+            enforce_minimum_batch(stats, primary_num_chunks(row, max_target_chunk_length), my_core_options.minimum_batch_elements);
+        }
+
+        // Returning any bytes that can't be used for whole slabs, so that they are available to extractors that are created later.
+        // No overflow is possible as the slabs were sized to fit in the reservation.
+        reservation.shrink(stats.max_slabs_in_cache * stats.slab_size_in_elements * sizeof(CachedValue_));
 
         const auto& map = chunk_map(row);
         const auto& ticks = chunk_ticks(row);
@@ -265,10 +758,12 @@ private:
         if (!my_sparse) {
             if (solo) {
                 output.reset(
-                    new FromDense_<true, oracle_, Value_, Index_, CachedValue_>(
+                    new Reserved<FromDense_<true, oracle_, Value_, Index_, CachedValue_> >(
+                        std::move(reservation),
                         my_seed,
                         my_dense_extractor,
                         row,
+                        my_core_options,
                         std::move(oracle),
                         std::forward<Args_>(args)...,
                         ticks,
@@ -279,10 +774,12 @@ private:
 
             } else {
                 output.reset(
-                    new FromDense_<false, oracle_, Value_, Index_, CachedValue_>( 
+                    new Reserved<FromDense_<false, oracle_, Value_, Index_, CachedValue_> >(
+                        std::move(reservation),
                         my_seed,
                         my_dense_extractor,
                         row,
+                        my_core_options,
                         std::move(oracle),
                         std::forward<Args_>(args)...,
                         ticks,
@@ -295,10 +792,12 @@ private:
         } else {
             if (solo) {
                 output.reset(
-                    new FromSparse_<true, oracle_, Value_, Index_, CachedValue_, CachedIndex_>(
+                    new Reserved<FromSparse_<true, oracle_, Value_, Index_, CachedValue_, CachedIndex_> >(
+                        std::move(reservation),
                         my_seed,
                         my_sparse_extractor,
                         row,
+                        my_core_options,
                         std::move(oracle),
                         std::forward<Args_>(args)...,
                         max_target_chunk_length,
@@ -310,10 +809,12 @@ private:
 
             } else {
                 output.reset(
-                    new FromSparse_<false, oracle_, Value_, Index_, CachedValue_, CachedIndex_>( 
+                    new Reserved<FromSparse_<false, oracle_, Value_, Index_, CachedValue_, CachedIndex_> >(
+                        std::move(reservation),
                         my_seed,
                         my_sparse_extractor,
                         row,
+                        my_core_options,
                         std::move(oracle),
                         std::forward<Args_>(args)...,
                         max_target_chunk_length,
@@ -452,15 +953,26 @@ public:
         const tatami::Options& opt, 
         Args_&& ... args
     ) const {
+        const std::size_t element_size = (opt.sparse_extract_index ? sizeof(CachedIndex_) : 0) + (opt.sparse_extract_value ? sizeof(CachedValue_) : 0);
+        CacheBudget::Reservation reservation;
+        const auto cache_size = reserve_cache(row, non_target_length, element_size, oracle_, reservation);
+
         Index_ max_target_chunk_length = max_primary_chunk_length(row);
         tatami_chunked::SlabCacheStats<Index_> stats(
             /* target_length = */ max_target_chunk_length,
             /* non_target_length = */ non_target_length, 
             /* target_num_slabs = */ primary_num_chunks(row, max_target_chunk_length),
-            /* cache_size_in_bytes = */ my_cache_size_in_bytes, 
-            /* element_size = */ (opt.sparse_extract_index ? sizeof(CachedIndex_) : 0) + (opt.sparse_extract_value ? sizeof(CachedValue_) : 0),
-            /* require_minimum_cache = */ my_require_minimum_cache
+            /* cache_size_in_bytes = */ cache_size, 
+            /* element_size = */ element_size,
+            /* require_minimum_cache = */ my_require_minimum_cache && !my_cache_budget
         );
+        if constexpr(oracle_) {
+            enforce_minimum_batch(stats, primary_num_chunks(row, max_target_chunk_length), my_core_options.minimum_batch_elements);
+        }
+
+        // Returning any bytes that can't be used for whole slabs, so that they are available to extractors that are created later.
+        // No overflow is possible as the slabs were sized to fit in the reservation.
+        reservation.shrink(stats.max_slabs_in_cache * stats.slab_size_in_elements * element_size);
 
         const auto& map = chunk_map(row);
         const auto& ticks = chunk_ticks(row);
@@ -475,10 +987,12 @@ public:
 
         if (solo) {
             output.reset(
-                new FromSparse_<true, oracle_, Value_, Index_, CachedValue_, CachedIndex_>( 
+                new Reserved<FromSparse_<true, oracle_, Value_, Index_, CachedValue_, CachedIndex_> >(
+                    std::move(reservation),
                     my_seed,
                     my_sparse_extractor,
                     row,
+                    my_core_options,
                     std::move(oracle),
                     std::forward<Args_>(args)...,
                     max_target_chunk_length,
@@ -492,10 +1006,12 @@ public:
 
         } else {
             output.reset(
-                new FromSparse_<false, oracle_, Value_, Index_, CachedValue_, CachedIndex_>( 
+                new Reserved<FromSparse_<false, oracle_, Value_, Index_, CachedValue_, CachedIndex_> >(
+                    std::move(reservation),
                     my_seed,
                     my_sparse_extractor,
                     row,
+                    my_core_options,
                     std::move(oracle),
                     std::forward<Args_>(args)...,
                     max_target_chunk_length,
@@ -0,0 +1,225 @@
+#ifndef TATAMI_PYTHON_CACHE_BUDGET_HPP
+#define TATAMI_PYTHON_CACHE_BUDGET_HPP
+
+#include "tatami/tatami.hpp"
+
+#include <mutex>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <algorithm>
+
+/**
+ * @file cache_budget.hpp
+ * @brief Cache budget shared across extractors.
+ */
+
+namespace tatami_python {
+
+/**
+ * @brief Byte budget for the caches of multiple extractors.
+ *
+ * By default, `UnknownMatrixOptions::maximum_cache_size` applies to each extractor separately,
+ * so the total memory usage scales with the number of threads and the number of `UnknownMatrix` instances.
+ * Instead, a single `CacheBudget` can be shared between all `UnknownMatrix` instances in a process via `UnknownMatrixOptions::cache_budget`.
+ * Each extractor then reserves part of the budget upon its construction and releases it upon its destruction,
+ * such that the sum of all cache sizes is capped at `total()`.
+ *
+ * Each extractor reserves the lesser of its demand (i.e., the cache size that it would have used without the budget) and the available bytes.
+ * To avoid starving extractors that are created later, each extractor will leave a fair share of `total() / expected_extractors` for each of the remaining expected extractors;
+ * once the expected number of extractors are active, later extractors can reserve whatever is left.
+ * If no bytes are available, the extractor will not cache any chunks, i.e., it will make a separate Python call for each row/column.
+ *
+ * This is a static partitioning of the budget, not a dynamic balancing between extractors.
+ * Each extractor immediately returns any part of its reservation that cannot be used for whole slabs, but otherwise holds its reservation until it is destroyed.
+ * Reservations are never enlarged after their creation, even if other extractors release their bytes;
+ * this ensures that the sum of all reservations never exceeds `total()`, even when the budget is over-subscribed.
+ *
+ * This class is thread-safe.
+ */
+class CacheBudget {
+public:
+    /**
+     * @param total Total size of the budget, in bytes.
+     * @param expected_extractors Expected number of extractors that will be active at once, e.g., the number of threads.
+     */
+    CacheBudget(const std::size_t total, const std::size_t expected_extractors = 1) :
+        my_total(total),
+        my_expected(std::max(expected_extractors, static_cast<std::size_t>(1)))
+    {}
+
+private:
+    mutable std::mutex my_lock;
+    std::size_t my_total, my_expected;
+    std::size_t my_reserved = 0;
+    std::size_t my_peak = 0;
+    std::size_t my_active = 0;
+
+public:
+    /**
+     * @brief Part of the budget that was reserved for a single extractor.
+     *
+     * The reservation is released when this object is destroyed.
+     */
+    class Reservation {
+    public:
+        /**
+         * @cond
+         */
+        Reservation() = default;
+
+        Reservation(CacheBudget& parent, const std::size_t bytes) : my_parent(&parent), my_bytes(bytes) {}
+
+        Reservation(Reservation&& other) noexcept : my_parent(other.my_parent), my_bytes(other.my_bytes) {
+            other.my_parent = NULL;
+        }
+
+        Reservation& operator=(Reservation&& other) noexcept {
+            if (this != &other) {
+                release();
+                my_parent = other.my_parent;
+                my_bytes = other.my_bytes;
+                other.my_parent = NULL;
+            }
+            return *this;
+        }
+
+        Reservation(const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+
+        ~Reservation() {
+            release();
+        }
+        /**
+         * @endcond
+         */
+
+    private:
+        CacheBudget* my_parent = NULL;
+        std::size_t my_bytes = 0;
+
+        void release() {
+            if (my_parent) {
+                my_parent->release(my_bytes);
+                my_parent = NULL;
+            }
+        }
+
+    public:
+        /**
+         * @return Number of bytes that were reserved.
+         */
+        std::size_t bytes() const {
+            return my_bytes;
+        }
+
+        /**
+         * Return part of the reservation to the budget, e.g., if the cache cannot use all of the reserved bytes.
+         * The returned bytes are then available to extractors that are created later.
+         *
+         * @param bytes Number of bytes to keep.
+         * This has no effect if it is not less than `bytes()`.
+         */
+        void shrink(const std::size_t bytes) {
+            if (my_parent && bytes < my_bytes) {
+                my_parent->give_back(my_bytes - bytes);
+                my_bytes = bytes;
+            }
+        }
+    };
+
+    /**
+     * @param demand Number of bytes that the extractor would like to reserve.
+     * @return Reservation of up to `demand` bytes.
+     */
+    Reservation reserve(const std::size_t demand) {
+        std::lock_guard<std::mutex> lck(my_lock);
+        const std::size_t available = my_total - my_reserved;
+        const std::size_t share = my_total / my_expected;
+
+        // Holding back a fair share for each of the other extractors that we expect to be created.
+        const std::size_t others = (my_expected > my_active + 1 ? my_expected - my_active - 1 : 0);
+        const std::size_t held_back = std::min(available, share * others); // no overflow as 'others < my_expected'.
+
+        std::size_t granted = std::min(demand, available - held_back);
+        granted = std::max(granted, std::min({ demand, share, available }));
+
+        my_reserved += granted;
+        my_peak = std::max(my_peak, my_reserved);
+        ++my_active;
+        return Reservation(*this, granted);
+    }
+
+private:
+    void release(const std::size_t bytes) {
+        std::lock_guard<std::mutex> lck(my_lock);
+        my_reserved -= bytes;
+        --my_active;
+    }
+
+    void give_back(const std::size_t bytes) {
+        std::lock_guard<std::mutex> lck(my_lock);
+        my_reserved -= bytes;
+    }
+
+public:
+    /**
+     * @return Total size of the budget, in bytes.
+     */
+    std::size_t total() const {
+        return my_total;
+    }
+
+    /**
+     * @return Number of bytes that are currently reserved.
+     */
+    std::size_t reserved() const {
+        std::lock_guard<std::mutex> lck(my_lock);
+        return my_reserved;
+    }
+
+    /**
+     * @return Maximum number of bytes that were reserved at any one time.
+     */
+    std::size_t peak_reserved() const {
+        std::lock_guard<std::mutex> lck(my_lock);
+        return my_peak;
+    }
+
+    /**
+     * @return Number of extractors that currently hold a reservation.
+     */
+    std::size_t active() const {
+        std::lock_guard<std::mutex> lck(my_lock);
+        return my_active;
+    }
+};
+
+/**
+ * @cond
+ */
+// Holds a reservation for the lifetime of an extractor.
+// This is a separate base class of Reserved so that it is destroyed after the extractor, i.e., the cache is freed before the reservation is released.
+struct ReservationHolder {
+    ReservationHolder(CacheBudget::Reservation reservation) : my_reservation(std::move(reservation)) {}
+    CacheBudget::Reservation my_reservation;
+};
+
+// Attaches a reservation to an extractor class, which is empty if no budget is being used.
+// This derives from the extractor class so that calls to fetch() do not have to go through another layer of virtual functions.
+template<class Extractor_>
+class Reserved final : private ReservationHolder, public Extractor_ {
+public:
+    template<typename ... Args_>
+    Reserved(CacheBudget::Reservation reservation, Args_&& ... args) :
+        ReservationHolder(std::move(reservation)),
+        Extractor_(std::forward<Args_>(args)...)
+    {}
+};
+/**
+ * @endcond
+ */
+
+}
+
+#endif
@@ -0,0 +1,319 @@
+#ifndef TATAMI_PYTHON_CACHE_POLICY_HPP
+#define TATAMI_PYTHON_CACHE_POLICY_HPP
+
+#include "tatami_chunked/tatami_chunked.hpp"
+
+#include <list>
+#include <map>
+#include <unordered_map>
+#include <variant>
+#include <utility>
+#include <cstddef>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @file cache_policy.hpp
+ * @brief Eviction policies for the myopic slab cache.
+ */
+
+namespace tatami_python {
+
+/**
+ * Eviction policy for the slab cache used by myopic extractors.
+ *
+ * - `LRU`: evict the least recently used slab, as in `tatami_chunked::LruSlabCache`.
+ *   This is optimal for consecutive access but performs poorly for repeated scans that are larger than the cache.
+ * - `TWO_QUEUE`: a variant of the 2Q policy of Johnson and Shasha (1994).
+ *   Newly loaded slabs are held in a small FIFO queue, and are only promoted to the main LRU queue if they are requested again,
+ *   either while they are still in the FIFO queue or soon after their eviction from it.
+ *   This protects a frequently-used working set from being flushed by a scan, as the scanned slabs are only ever evicted from the FIFO queue.
+ * - `LFU`: evict the least frequently used slab, breaking ties by recency.
+ *   Usage counts are only retained for slabs in the cache.
+ */
+enum class CachePolicy : char { LRU, TWO_QUEUE, LFU };
+
+/**
+ * @brief Slab cache with a 2Q eviction policy.
+ *
+ * This has the same interface as `tatami_chunked::LruSlabCache`.
+ *
+ * @tparam Id_ Type of slab identifier, typically integer.
+ * @tparam Slab_ Class for a single slab.
+ */
+template<typename Id_, class Slab_>
+class TwoQueueSlabCache {
+public:
+    /**
+     * @param max_slabs Maximum number of slabs to store.
+     * This should be positive.
+     */
+    TwoQueueSlabCache(const std::size_t max_slabs) :
+        my_max_slabs(max_slabs),
+        my_max_recent(std::max(max_slabs / 4, static_cast<std::size_t>(1))),
+        my_max_ghosts(std::max(max_slabs / 2, static_cast<std::size_t>(1)))
+    {
+        // Otherwise, find() would have nothing to evict when the cache is 'full'.
+        if (max_slabs == 0) {
+            throw std::runtime_error("maximum number of slabs should be positive");
+        }
+    }
+
+private:
+    typedef std::list<std::pair<Slab_, Id_> > SlabList;
+    typedef typename SlabList::iterator SlabIterator;
+
+    std::size_t my_max_slabs, my_max_recent, my_max_ghosts;
+
+    // Slabs that have only been requested once since they were loaded, in FIFO order.
+    // This is limited to 'my_max_recent' slabs once the cache is full, except when 'my_frequent' is empty.
+    SlabList my_recent;
+    // Slabs that have been requested again, in LRU order.
+    SlabList my_frequent;
+    std::unordered_map<Id_, std::pair<bool, SlabIterator> > my_present;
+
+    // Identities of slabs that were recently evicted from 'my_recent', in FIFO order.
+    std::list<Id_> my_ghosts;
+    std::unordered_map<Id_, typename std::list<Id_>::iterator> my_ghost_present;
+
+public:
+    /**
+     * @tparam Cfunction_ Function to create a new `Slab_`.
+     * @tparam Pfunction_ Function to populate a `Slab_` with the contents of a slab.
+     *
+     * @param id Identifier of the slab to retrieve.
+     * @param create Function that accepts no arguments and returns a new `Slab_` instance.
+     * @param populate Function that accepts `id` and a reference to a `Slab_` instance, and populates the latter with the contents of the slab.
+     *
+     * @return Reference to a slab containing the contents of `id`.
+     * This is valid until the next call to `find()`.
+     */
+    template<class Cfunction_, class Pfunction_>
+    const Slab_& find(const Id_ id, Cfunction_ create, Pfunction_ populate) {
+        auto it = my_present.find(id);
+        if (it != my_present.end()) {
+            auto& info = it->second;
+            if (info.first) {
+                my_frequent.splice(my_frequent.end(), my_frequent, info.second);
+            } else {
+                my_frequent.splice(my_frequent.end(), my_recent, info.second);
+                info.first = true;
+            }
+            return info.second->first;
+        }
+
+        // Slabs that were recently evicted from 'my_recent' are promoted straight into 'my_frequent'.
+        auto gIt = my_ghost_present.find(id);
+        const bool promote = (gIt != my_ghost_present.end());
+        if (promote) {
+            my_ghosts.erase(gIt->second);
+            my_ghost_present.erase(gIt);
+        }
+        auto& destination = (promote ? my_frequent : my_recent);
+
+        if (my_present.size() < my_max_slabs) {
+            destination.emplace_back(create(), id);
+        } else if (my_recent.size() > my_max_recent || my_frequent.empty()) {
+            const auto oldest = my_recent.begin();
+            remember(oldest->second);
+            my_present.erase(oldest->second);
+            destination.splice(destination.end(), my_recent, oldest);
+        } else {
+            const auto oldest = my_frequent.begin();
+            my_present.erase(oldest->second);
+            destination.splice(destination.end(), my_frequent, oldest);
+        }
+
+        auto latest = std::prev(destination.end());
+        latest->second = id;
+        my_present[id] = std::make_pair(promote, latest);
+        populate(id, latest->first);
+        return latest->first;
+    }
+
+private:
+    void remember(const Id_ id) {
+        if (my_ghosts.size() >= my_max_ghosts) {
+            my_ghost_present.erase(my_ghosts.front());
+            my_ghosts.pop_front();
+        }
+        my_ghosts.push_back(id);
+        my_ghost_present[id] = std::prev(my_ghosts.end());
+    }
+
+public:
+    /**
+     * @return Maximum number of slabs in the cache.
+     */
+    std::size_t get_max_slabs() const {
+        return my_max_slabs;
+    }
+
+    /**
+     * @return Number of slabs currently in the cache.
+     */
+    std::size_t get_num_slabs() const {
+        return my_present.size();
+    }
+};
+
+/**
+ * @brief Slab cache with a least-frequently-used eviction policy.
+ *
+ * This has the same interface as `tatami_chunked::LruSlabCache`.
+ *
+ * @tparam Id_ Type of slab identifier, typically integer.
+ * @tparam Slab_ Class for a single slab.
+ */
+template<typename Id_, class Slab_>
+class LfuSlabCache {
+public:
+    /**
+     * @param max_slabs Maximum number of slabs to store.
+     * This should be positive.
+     */
+    LfuSlabCache(const std::size_t max_slabs) : my_max_slabs(max_slabs) {
+        if (max_slabs == 0) {
+            throw std::runtime_error("maximum number of slabs should be positive");
+        }
+    }
+
+private:
+    // Usage count and time of last use, in that order, so that the first key is the least frequently (and then least recently) used slab.
+    // Times are unique, so there are no ties between keys.
+    typedef std::pair<std::size_t, std::size_t> UsageKey;
+
+    struct Entry {
+        Entry(Slab_ s, const Id_ i) : slab(std::move(s)), id(i) {}
+        Slab_ slab;
+        Id_ id;
+        UsageKey usage;
+    };
+
+    typedef typename std::list<Entry>::iterator EntryIterator;
+
+    std::size_t my_max_slabs;
+    std::list<Entry> my_entries;
+    std::unordered_map<Id_, EntryIterator> my_present;
+    std::map<UsageKey, EntryIterator> my_usage;
+    std::size_t my_clock = 0;
+
+public:
+    /**
+     * @tparam Cfunction_ Function to create a new `Slab_`.
+     * @tparam Pfunction_ Function to populate a `Slab_` with the contents of a slab.
+     *
+     * @param id Identifier of the slab to retrieve.
+     * @param create Function that accepts no arguments and returns a new `Slab_` instance.
+     * @param populate Function that accepts `id` and a reference to a `Slab_` instance, and populates the latter with the contents of the slab.
+     *
+     * @return Reference to a slab containing the contents of `id`.
+     * This is valid until the next call to `find()`.
+     */
+    template<class Cfunction_, class Pfunction_>
+    const Slab_& find(const Id_ id, Cfunction_ create, Pfunction_ populate) {
+        ++my_clock;
+        auto it = my_present.find(id);
+        if (it != my_present.end()) {
+            auto& entry = *(it->second);
+            auto node = my_usage.extract(entry.usage);
+            ++(entry.usage.first);
+            entry.usage.second = my_clock;
+            node.key() = entry.usage;
+            my_usage.insert(std::move(node));
+            return entry.slab;
+        }
+
+        EntryIterator chosen;
+        if (my_present.size() < my_max_slabs) {
+            my_entries.emplace_back(create(), id);
+            chosen = std::prev(my_entries.end());
+        } else {
+            auto first = my_usage.begin();
+            chosen = first->second;
+            my_usage.erase(first);
+            my_present.erase(chosen->id);
+        }
+
+        chosen->id = id;
+        chosen->usage = UsageKey(1, my_clock);
+        my_usage.emplace(chosen->usage, chosen);
+        my_present[id] = chosen;
+        populate(id, chosen->slab);
+        return chosen->slab;
+    }
+
+    /**
+     * @return Maximum number of slabs in the cache.
+     */
+    std::size_t get_max_slabs() const {
+        return my_max_slabs;
+    }
+
+    /**
+     * @return Number of slabs currently in the cache.
+     */
+    std::size_t get_num_slabs() const {
+        return my_present.size();
+    }
+};
+
+/**
+ * @brief Slab cache with a runtime choice of eviction policy.
+ *
+ * This has the same interface as `tatami_chunked::LruSlabCache`, and dispatches to the cache class for the chosen `CachePolicy`.
+ *
+ * @tparam Id_ Type of slab identifier, typically integer.
+ * @tparam Slab_ Class for a single slab.
+ */
+template<typename Id_, class Slab_>
+class PolicySlabCache {
+public:
+    /**
+     * @param policy Eviction policy.
+     * @param max_slabs Maximum number of slabs to store.
+     */
+    PolicySlabCache(const CachePolicy policy, const std::size_t max_slabs) {
+        switch (policy) {
+            case CachePolicy::TWO_QUEUE:
+                my_cache.template emplace<TwoQueueSlabCache<Id_, Slab_> >(max_slabs);
+                break;
+            case CachePolicy::LFU:
+                my_cache.template emplace<LfuSlabCache<Id_, Slab_> >(max_slabs);
+                break;
+            default:
+                my_cache.template emplace<tatami_chunked::LruSlabCache<Id_, Slab_> >(max_slabs);
+        }
+    }
+
+private:
+    std::variant<std::monostate, tatami_chunked::LruSlabCache<Id_, Slab_>, TwoQueueSlabCache<Id_, Slab_>, LfuSlabCache<Id_, Slab_> > my_cache;
+
+public:
+    /**
+     * @tparam Cfunction_ Function to create a new `Slab_`.
+     * @tparam Pfunction_ Function to populate a `Slab_` with the contents of a slab.
+     *
+     * @param id Identifier of the slab to retrieve.
+     * @param create Function that accepts no arguments and returns a new `Slab_` instance.
+     * @param populate Function that accepts `id` and a reference to a `Slab_` instance, and populates the latter with the contents of the slab.
+     *
+     * @return Reference to a slab containing the contents of `id`.
+     * This is valid until the next call to `find()`.
+     */
+    template<class Cfunction_, class Pfunction_>
+    const Slab_& find(const Id_ id, Cfunction_ create, Pfunction_ populate) {
+        if (auto lru = std::get_if<tatami_chunked::LruSlabCache<Id_, Slab_> >(&my_cache)) {
+            return lru->find(id, std::move(create), std::move(populate));
+        } else if (auto twoq = std::get_if<TwoQueueSlabCache<Id_, Slab_> >(&my_cache)) {
+            return twoq->find(id, std::move(create), std::move(populate));
+        } else {
+            return std::get<LfuSlabCache<Id_, Slab_> >(my_cache).find(id, std::move(create), std::move(populate));
+        }
+    }
+};
+
+}
+
+#endif
@@ -2,11 +2,16 @@
 #define TATAMI_R_DENSE_EXTRACTOR_HPP
 
 #include "pybind11/pybind11.h"
+#include "pybind11/numpy.h"
 #include "tatami/tatami.hpp"
 #include "tatami_chunked/tatami_chunked.hpp"
 #include "sanisizer/sanisizer.hpp"
 
 #include "utils.hpp"
+#include "ticks.hpp"
+#include "granularity.hpp"
+#include "read_ahead.hpp"
+#include "cache_policy.hpp"
 #include "dense_matrix.hpp"
 #include "parallelize.hpp"
 
@@ -14,6 +19,7 @@
 #include <stdexcept>
 #include <type_traits>
 #include <optional>
+#include <memory>
 
 namespace tatami_python {
 
@@ -21,30 +27,153 @@ namespace tatami_python {
 //
 // - No need to protect against overflows when creating pybind11::array_t<Index_t> from dimension extents.
 //   We already know that the dimension extent can be safely converted to/from an int, based on checks in the UnknownMatrix constructor.
+//
+// - fetch_raw() returns a pointer into the cached slab when CachedValue_ is the same as Value_, otherwise it copies into the buffer.
+//   Slab pointers are only guaranteed to be valid until the next fetch() call, which is consistent with tatami's contract for the returned pointer.
+
+// - If CoreOptions::use_out is true, we pass a writable view of the slab to the extraction function via 'out='.
+//   This allows backends to write directly into the slab without any intermediate allocation or copy.
+//   For oracle-aware batches of multiple chunks, we instead pass a view of a reusable staging buffer, from which each chunk is copied into its slab.
+//   Support for 'out=' is detected once by the UnknownMatrix constructor (see accepts_out_argument()), so any exception from the backend is propagated as usual.
+//
+// - If CoreOptions::read_ahead is true, MyopicDenseCore switches to an internal OracularDenseCore when it detects a constant stride in the requests.
+//   This is created with its own cache on each switch, and is discarded as soon as a request deviates from the predicted sequence.
+//
+// - Each core reports the bytes held by its slabs and its pinned non-target array to CoreOptions::memory.
+//   Results from Python are also tracked for the duration of each call, assuming that they have the same type as CachedValue_.
+
+template<typename Index_, typename CachedValue_>
+pybind11::array_t<CachedValue_> create_slab_view(CachedValue_* const slab, const bool row, const Index_ target_length, const Index_ non_target_length) {
+    // No-op capsule is used as the base so that pybind11 doesn't copy the slab contents.
+    pybind11::capsule base(slab, [](void*) -> void {});
+    const pybind11::ssize_t tlen = target_length, ntlen = non_target_length;
+    const pybind11::ssize_t size = sizeof(CachedValue_);
+    if (row) {
+        // Each row of the chunk is contiguous in the slab, i.e., a C-contiguous (chunk length, non-target length) array.
+        return pybind11::array_t<CachedValue_>({ tlen, ntlen }, { ntlen * size, size }, slab, base);
+    } else {
+        // Each column of the chunk is contiguous in the slab, i.e., an F-contiguous (non-target length, chunk length) array.
+        return pybind11::array_t<CachedValue_>({ ntlen, tlen }, { size, ntlen * size }, slab, base);
+    }
+}
+
+inline bool accepts_out_argument(const pybind11::object& extractor) {
+    // An explicit declaration takes precedence, e.g., for wrappers that forward all keyword arguments but don't know if the wrapped function supports 'out='.
+    if (pybind11::hasattr(extractor, "supports_out")) {
+        return extractor.attr("supports_out").template cast<bool>();
+    }
+
+    auto inspect = pybind11::module::import("inspect");
+    pybind11::object sig;
+    try {
+        sig = inspect.attr("signature")(extractor);
+    } catch (pybind11::error_already_set& e) {
+        // Some callables (e.g., certain built-ins) have no signature, in which case we can't assume that 'out=' is supported.
+        if (e.matches(PyExc_ValueError) || e.matches(PyExc_TypeError)) {
+            return false;
+        }
+        throw;
+    }
+
+    auto params = sig.attr("parameters");
+    if (params.attr("__contains__")("out").template cast<bool>()) {
+        return true;
+    }
+    auto var_keyword = inspect.attr("Parameter").attr("VAR_KEYWORD");
+    for (auto param : params.attr("values")()) {
+        if (param.attr("kind").equal(var_keyword)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+template<typename Index_, typename CachedValue_>
+void extract_dense_slab(
+    const pybind11::object& extractor,
+    const pybind11::object& matrix,
+    const CoreOptions& options,
+    const pybind11::tuple& args,
+    const bool use_out,
+    const bool row,
+    CachedValue_* const slab,
+    const Index_ target_length,
+    const Index_ non_target_length
+) {
+    pybind11::object obj;
+    if (use_out) {
+        auto view = create_slab_view(slab, row, target_length, non_target_length);
+        obj = extractor(matrix, args, pybind11::arg("out") = view);
+        if (obj.is(view)) {
+            return;
+        }
+        // Backends are allowed to ignore 'out=' and return something else, in which case we parse it as usual.
+    } else {
+        obj = call_extractor(extractor, matrix, options, args);
+    }
+
+    if (row) {
+        parse_dense_matrix<Index_>(obj, 0, 0, true, slab, target_length, non_target_length);
+    } else {
+        parse_dense_matrix<Index_>(obj, 0, 0, false, slab, non_target_length, target_length);
+    }
+}
+
+template<typename Index_, typename Value_>
+void extract_dense_element(
+    const pybind11::object& extractor,
+    const pybind11::object& matrix,
+    const CoreOptions& options,
+    pybind11::tuple& args,
+    const bool row,
+    const Index_ i,
+    Value_* const buffer,
+    const Index_ non_target_length
+) {
+    args[static_cast<int>(!row)] = create_indexing_array<Index_>(i, 1);
+    auto obj = call_extractor(extractor, matrix, options, args);
+    if (row) {
+        parse_dense_matrix<Index_>(obj, 0, 0, true, buffer, 1, non_target_length);
+    } else {
+        parse_dense_matrix<Index_>(obj, 0, 0, false, buffer, non_target_length, 1);
+    }
+}
+
+// Bytes allocated by the slab factory, which creates all slabs up front.
+template<typename CachedValue_, typename Index_>
+std::size_t dense_cache_bytes(const tatami_chunked::SlabCacheStats<Index_>& stats) {
+    return sizeof(CachedValue_) * stats.slab_size_in_elements * stats.max_slabs_in_cache; // no overflow as the slabs have already been allocated.
+}
 
 /********************
  *** Core classes ***
  ********************/
 
-template<bool oracle_, typename Index_> 
+template<bool oracle_, typename Index_, typename CachedValue_>
 class SoloDenseCore {
 public:
     SoloDenseCore(
         const pybind11::object& matrix, 
         const pybind11::object& dense_extractor,
         bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         pybind11::array non_target_extract, 
-        [[maybe_unused]] const std::vector<Index_>& ticks, // provided here for compatibility with the other Dense*Core classes.
-        [[maybe_unused]] const std::vector<Index_>& map,
-        [[maybe_unused]] const tatami_chunked::SlabCacheStats<Index_>& stats
+        const std::vector<Index_>& ticks, // only used for recording accesses, see CoreOptions::trace.
+        const ChunkLookup<Index_>& map,
+        [[maybe_unused]] const tatami_chunked::SlabCacheStats<Index_>& stats // provided here for compatibility with the other Dense*Core classes.
     ) :
         my_matrix(matrix),
         my_dense_extractor(dense_extractor),
+        my_options(options),
         my_row(row),
         my_non_target_length(non_target_extract.size()),
-        my_oracle(std::move(oracle))
+        my_chunk_ticks(ticks),
+        my_chunk_map(map),
+        my_oracle(std::move(oracle)),
+        my_memory(options.memory, non_target_extract.nbytes())
     {
+        my_trace_tag = create_trace_tag(options);
         my_extract_args.emplace(2);
         (*my_extract_args)[static_cast<int>(row)] = std::move(non_target_extract);
     }
@@ -60,40 +189,49 @@ public:
 private:
     const pybind11::object& my_matrix;
     const pybind11::object& my_dense_extractor;
+    const CoreOptions& my_options;
     std::optional<pybind11::tuple> my_extract_args;
 
     bool my_row;
     Index_ my_non_target_length;
 
+    const std::vector<Index_>& my_chunk_ticks;
+    const ChunkLookup<Index_>& my_chunk_map;
+
     tatami::MaybeOracle<oracle_, Index_> my_oracle;
     typename std::conditional<oracle_, tatami::PredictionIndex, bool>::type my_counter = 0;
 
+    TrackedMemory my_memory;
+    TraceTag my_trace_tag;
+
 public:
     template<typename Value_>
-    void fetch_raw(Index_ i, Value_* const buffer) {
+    const Value_* fetch_raw(Index_ i, Value_* const buffer) {
         if constexpr(oracle_) {
             i = my_oracle->get(my_counter++);
         }
+        if (my_options.trace) {
+            record_access(my_options, my_trace_tag, my_row, my_chunk_ticks, my_chunk_map[i], sizeof(CachedValue_) * static_cast<std::size_t>(my_non_target_length));
+        }
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
-        TATAMI_PYTHON_SERIALIZE([&]() -> void {
+        serialize(my_options.thread_safe, [&]() -> void {
 #endif
 
-        (*my_extract_args)[static_cast<int>(!my_row)] = create_indexing_array<Index_>(i, 1);
-        auto obj = my_dense_extractor(my_matrix, *my_extract_args);
-
-        if (my_row) {
-            parse_dense_matrix<Index_>(obj, 0, 0, true, buffer, 1, my_non_target_length);
-        } else {
-            parse_dense_matrix<Index_>(obj, 0, 0, false, buffer, my_non_target_length, 1);
-        }
+        TrackedMemory in_flight(my_options.memory, sizeof(CachedValue_) * static_cast<std::size_t>(my_non_target_length));
+        extract_dense_element(my_dense_extractor, my_matrix, my_options, *my_extract_args, my_row, i, buffer, my_non_target_length);
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
         });
 #endif
+
+        return buffer;
     }
 };
 
+template<typename Index_, typename CachedValue_>
+class OracularDenseCore;
+
 template<typename Index_, typename CachedValue_>
 class MyopicDenseCore {
 public:
@@ -101,21 +239,36 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& dense_extractor,
         bool row,
+        const CoreOptions& options,
         [[maybe_unused]] tatami::MaybeOracle<false, Index_> oracle, // provided here for compatibility with the other Dense*Core classes.
         pybind11::array non_target_extract, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats
     ) :
         my_matrix(matrix),
         my_dense_extractor(dense_extractor),
+        my_options(options),
         my_row(row),
         my_non_target_length(non_target_extract.size()),
         my_chunk_ticks(ticks),
         my_chunk_map(map),
-        my_factory(stats),
-        my_cache(stats.max_slabs_in_cache)
+        my_read_ahead_slabs(read_ahead_slabs(options.read_ahead, stats)),
+        my_stats(remove_read_ahead_slabs(stats, my_read_ahead_slabs)),
+        my_factory(my_stats),
+        my_cache(options.cache_policy, my_stats.max_slabs_in_cache),
+        my_use_out(options.use_out && !options.event_loop.has_value()),
+        my_memory(options.memory, non_target_extract.nbytes() + dense_cache_bytes<CachedValue_>(my_stats))
     {
+        // No point adapting the granularity if each chunk only contains one element anyway.
+        if (worth_adapting_granularity(options.adaptive_granularity, my_stats.slab_size_in_elements, my_non_target_length)) {
+            my_granularity.emplace(my_stats.max_slabs_in_cache);
+        }
+        // Similarly, no point reading ahead if either cache can't hold more than one chunk at a time, see read_ahead_slabs().
+        if (my_read_ahead_slabs) {
+            my_stride.emplace();
+        }
+        my_trace_tag = create_trace_tag(options);
         my_extract_args.emplace(2);
         (*my_extract_args)[static_cast<int>(row)] = std::move(non_target_extract);
     }
@@ -131,43 +284,164 @@ public:
 private:
     const pybind11::object& my_matrix;
     const pybind11::object& my_dense_extractor;
+    const CoreOptions& my_options;
     std::optional<pybind11::tuple> my_extract_args;
 
     bool my_row;
     Index_ my_non_target_length;
 
     const std::vector<Index_>& my_chunk_ticks;
-    const std::vector<Index_>& my_chunk_map;
+    const ChunkLookup<Index_>& my_chunk_map;
+    std::size_t my_read_ahead_slabs; // taken from the cache in 'stats', so my_stats only refers to the myopic cache.
+    tatami_chunked::SlabCacheStats<Index_> my_stats;
 
     tatami_chunked::DenseSlabFactory<CachedValue_> my_factory;
     typedef typename decltype(my_factory)::Slab Slab;
-    tatami_chunked::LruSlabCache<Index_, Slab> my_cache;
+    PolicySlabCache<Index_, Slab> my_cache;
+
+    const bool my_use_out;
+    TrackedMemory my_memory;
+    TraceTag my_trace_tag;
+    std::optional<GranularityPolicy<Index_> > my_granularity;
+
+    std::optional<StrideDetector<Index_> > my_stride;
+    std::optional<Index_> my_last_chunk;
+    std::size_t my_num_read_ahead = 0;
+    std::size_t my_shared_bytes = 0;
+    std::shared_ptr<const StrideOracle<Index_> > my_read_ahead_oracle;
+    tatami::PredictionIndex my_read_ahead_counter = 0;
+    std::optional<OracularDenseCore<Index_, CachedValue_> > my_read_ahead;
+
+    void start_read_ahead(const Index_ i) {
+        // The read-ahead core is oracle-aware, so its batches are subject to the same minimum size as those of the oracle-aware extractors.
+        auto read_ahead_stats = my_stats;
+        read_ahead_stats.max_slabs_in_cache = my_read_ahead_slabs;
+        enforce_minimum_batch(read_ahead_stats, static_cast<Index_>(my_chunk_ticks.size() - 1), my_options.minimum_batch_elements);
+
+        const auto limit = read_ahead_limit(my_chunk_ticks, my_chunk_map[i], my_stride->forward(), read_ahead_stats.max_slabs_in_cache);
+        my_read_ahead_oracle = std::make_shared<const StrideOracle<Index_> >(i, my_stride->step(), my_stride->forward(), limit);
+        my_read_ahead_counter = 1;
+
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+        serialize(my_options.thread_safe, [&]() -> void {
+#endif
+
+        auto non_target_extract = (*my_extract_args)[static_cast<int>(my_row)].template cast<pybind11::array>();
+        my_read_ahead.emplace(
+            my_matrix,
+            my_dense_extractor,
+            my_row,
+            my_options,
+            my_read_ahead_oracle,
+            non_target_extract,
+            my_chunk_ticks,
+            my_chunk_map,
+            read_ahead_stats,
+            TraceTag{ my_trace_tag.extractor, ++my_num_read_ahead }
+        );
+
+        // The read-ahead core counts the non-target array towards the memory usage, so we stop counting it here to avoid double-counting.
+        my_shared_bytes = non_target_extract.nbytes();
+        my_memory.resize(my_memory.bytes() - my_shared_bytes);
+
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+        });
+#endif
+    }
+
+    void stop_read_ahead() {
+        my_read_ahead.reset();
+        my_memory.resize(my_memory.bytes() + my_shared_bytes);
+        my_shared_bytes = 0;
+        my_read_ahead_oracle.reset();
+    }
+
+    bool use_read_ahead(const Index_ i) {
+        if (!my_stride.has_value()) {
+            return false;
+        }
+
+        if (my_read_ahead.has_value()) {
+            if (my_read_ahead_counter < my_read_ahead_oracle->total() && my_read_ahead_oracle->get(my_read_ahead_counter) == i) {
+                ++my_read_ahead_counter;
+                return true;
+            }
+
+            // Predictions only extend as far as the read-ahead cache can hold, so we start a new oracle if the request continues the sequence.
+            // This lies in a chunk beyond the previous predictions, so the chunks in the previous read-ahead cache will not be needed again.
+            const bool continued = (my_read_ahead_counter == my_read_ahead_oracle->total() && my_read_ahead_oracle->continued_by(i));
+            stop_read_ahead();
+            if (continued) {
+                start_read_ahead(i);
+                return true;
+            }
+
+            // Otherwise, the request deviates from the predicted sequence, so we go back to myopic extraction and start looking for a new stride.
+            my_stride->reset();
+        }
+
+        if (!my_stride->record(i)) {
+            return false;
+        }
+
+        // If the request lies in the chunk that was last loaded into the myopic cache, we continue to serve it from the myopic cache.
+        // This avoids refetching the same chunk into the read-ahead cache; the switch will occur when the sequence moves onto the next chunk.
+        if (my_last_chunk.has_value() && *my_last_chunk == my_chunk_map[i]) {
+            return false;
+        }
+
+        start_read_ahead(i);
+        increment_counter(my_options.counters.switches_to_read_ahead);
+        return true;
+    }
 
 public:
     template<typename Value_>
-    void fetch_raw(Index_ i, Value_* buffer) {
+    const Value_* fetch_raw(Index_ i, Value_* buffer) {
+        if (use_read_ahead(i)) {
+            return my_read_ahead->fetch_raw(i, buffer);
+        }
+
         auto chosen = my_chunk_map[i];
+        record_access(my_options, my_trace_tag, my_row, my_chunk_ticks, chosen, sizeof(CachedValue_) * static_cast<std::size_t>(my_non_target_length));
+
+        if (my_granularity.has_value() && !my_granularity->use_chunks()) {
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+            serialize(my_options.thread_safe, [&]() -> void {
+#endif
+
+            TrackedMemory in_flight(my_options.memory, sizeof(CachedValue_) * static_cast<std::size_t>(my_non_target_length));
+            extract_dense_element(my_dense_extractor, my_matrix, my_options, *my_extract_args, my_row, i, buffer, my_non_target_length);
+
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+            });
+#endif
+
+            increment_counter(my_options.counters.element_loads);
+            my_last_chunk.reset();
+            if (my_granularity->record_element_request(chosen)) {
+                increment_counter(my_options.counters.switches_to_chunk);
+            }
+            return buffer;
+        }
 
+        bool loaded = false;
         const auto& slab = my_cache.find(
             chosen,
             [&]() -> Slab {
                 return my_factory.create();
             },
             [&](Index_ id, Slab& cache) -> void {
+                loaded = true;
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
-                TATAMI_PYTHON_SERIALIZE([&]() -> void {
+                serialize(my_options.thread_safe, [&]() -> void {
 #endif
 
                 const auto chunk_start = my_chunk_ticks[id];
                 const Index_ chunk_len = my_chunk_ticks[id + 1] - chunk_start;
                 (*my_extract_args)[static_cast<int>(!my_row)] = create_indexing_array<Index_>(chunk_start, chunk_len);
-                auto obj = my_dense_extractor(my_matrix, *my_extract_args);
-
-                if (my_row) {
-                    parse_dense_matrix<Index_>(obj, 0, 0, true, cache.data, chunk_len, my_non_target_length);
-                } else {
-                    parse_dense_matrix<Index_>(obj, 0, 0, false, cache.data, my_non_target_length, chunk_len);
-                }
+                TrackedMemory in_flight(my_options.memory, (my_use_out ? 0 : sizeof(CachedValue_) * static_cast<std::size_t>(my_non_target_length) * chunk_len));
+                extract_dense_slab(my_dense_extractor, my_matrix, my_options, *my_extract_args, my_use_out, my_row, cache.data, chunk_len, my_non_target_length);
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
                 });
@@ -175,8 +449,16 @@ public:
             }
         );
 
+        if (loaded) {
+            increment_counter(my_options.counters.chunk_loads);
+        }
+        my_last_chunk = chosen;
+        if (my_granularity.has_value() && my_granularity->record_chunk_request(loaded)) {
+            increment_counter(my_options.counters.switches_to_element);
+        }
+
         auto shift = sanisizer::product_unsafe<std::size_t>(i - my_chunk_ticks[chosen], my_non_target_length);
-        std::copy_n(slab.data + shift, my_non_target_length, buffer);
+        return fetch_from_cache(slab.data + shift, my_non_target_length, buffer);
     }
 };
 
@@ -187,21 +469,29 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& dense_extractor,
         bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<true, Index_> oracle,
         pybind11::array non_target_extract, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
-        const tatami_chunked::SlabCacheStats<Index_>& stats
+        const ChunkLookup<Index_>& map,
+        const tatami_chunked::SlabCacheStats<Index_>& stats,
+        const std::optional<TraceTag>& parent_tag = std::nullopt // only set for the read-ahead core of a myopic extractor, see CoreOptions::trace.
     ) :
         my_matrix(matrix),
         my_dense_extractor(dense_extractor),
+        my_options(options),
         my_row(row),
         my_non_target_length(non_target_extract.size()),
         my_chunk_ticks(ticks),
         my_chunk_map(map),
         my_factory(stats),
-        my_cache(std::move(oracle), stats.max_slabs_in_cache)
+        my_cache(std::move(oracle), stats.max_slabs_in_cache),
+        my_use_out(options.use_out && !options.event_loop.has_value()),
+        my_memory(options.memory, non_target_extract.nbytes() + dense_cache_bytes<CachedValue_>(stats)),
+        my_max_batch_length(max_batch_length(options, non_target_extract.size())),
+        my_staging_memory(options.memory)
     {
+        my_trace_tag = (parent_tag.has_value() ? *parent_tag : create_trace_tag(options));
         my_extract_args.emplace(2);
         (*my_extract_args)[static_cast<int>(row)] = std::move(non_target_extract);
     }
@@ -217,24 +507,35 @@ public:
 private:
     const pybind11::object& my_matrix;
     const pybind11::object& my_dense_extractor;
+    const CoreOptions& my_options;
     std::optional<pybind11::tuple> my_extract_args;
 
     bool my_row;
     Index_ my_non_target_length;
 
     const std::vector<Index_>& my_chunk_ticks;
-    const std::vector<Index_>& my_chunk_map;
+    const ChunkLookup<Index_>& my_chunk_map;
 
     tatami_chunked::DenseSlabFactory<CachedValue_> my_factory;
     typedef typename decltype(my_factory)::Slab Slab;
     tatami_chunked::OracularSlabCache<Index_, Index_, Slab> my_cache;
 
+    const bool my_use_out;
+    TrackedMemory my_memory;
+    TraceTag my_trace_tag;
+    std::size_t my_max_batch_length;
+
+    // Only used for multi-chunk batches when my_use_out = true.
+    std::vector<CachedValue_> my_staging;
+    TrackedMemory my_staging_memory;
+
 public:
     template<typename Value_>
-    void fetch_raw(Index_, Value_* buffer) {
+    const Value_* fetch_raw(Index_, Value_* buffer) {
         auto res = my_cache.next(
             [&](Index_ i) -> std::pair<Index_, Index_> {
                 auto chosen = my_chunk_map[i];
+                record_access(my_options, my_trace_tag, my_row, my_chunk_ticks, chosen, sizeof(CachedValue_) * static_cast<std::size_t>(my_non_target_length));
                 return std::make_pair(chosen, static_cast<Index_>(i - my_chunk_ticks[chosen]));
             },
             [&]() -> Slab {
@@ -248,42 +549,127 @@ public:
                 if (!std::is_sorted(to_populate.begin(), to_populate.end(), cmp)) {
                     std::sort(to_populate.begin(), to_populate.end(), cmp);
                 }
-
-                Index_ total_len = 0;
-                for (const auto& p : to_populate) {
-                    total_len += my_chunk_ticks[p.first + 1] - my_chunk_ticks[p.first];
-                }
+                increment_counter(my_options.counters.chunk_loads, to_populate.size());
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
-                TATAMI_PYTHON_SERIALIZE([&]() -> void {
+                serialize(my_options.thread_safe, [&]() -> void {
 #endif
 
-                pybind11::array_t<Index_> primary_extract(total_len); // known to be safe, from the constructor.
-                auto pptr = static_cast<Index_*>(primary_extract.request().ptr);
-                Index_ current = 0;
-                for (const auto& p : to_populate) {
-                    const Index_ chunk_start = my_chunk_ticks[p.first];
+                // Slabs are not contiguous with each other, so we can only write directly into a slab when a single chunk is requested.
+                if (my_use_out && to_populate.size() == 1) {
+                    const auto& p = to_populate.front();
+                    const auto chunk_start = my_chunk_ticks[p.first];
                     const Index_ chunk_len = my_chunk_ticks[p.first + 1] - chunk_start;
-                    const auto start = pptr + current;
-                    std::iota(start, start + chunk_len, chunk_start);
-                    current += chunk_len;
+                    (*my_extract_args)[static_cast<int>(!my_row)] = create_indexing_array<Index_>(chunk_start, chunk_len);
+                    extract_dense_slab(my_dense_extractor, my_matrix, my_options, *my_extract_args, my_use_out, my_row, p.second->data, chunk_len, my_non_target_length);
+                    return;
                 }
 
-                (*my_extract_args)[static_cast<int>(!my_row)] = std::move(primary_extract);
-                auto obj = my_dense_extractor(my_matrix, *my_extract_args);
+                auto chunk_length = [&](const std::size_t x) -> Index_ {
+                    const auto id = to_populate[x].first;
+                    return my_chunk_ticks[id + 1] - my_chunk_ticks[id];
+                };
 
-                current = 0;
-                for (const auto& p : to_populate) {
-                    const auto chunk_start = my_chunk_ticks[p.first];
-                    const Index_ chunk_len = my_chunk_ticks[p.first + 1] - chunk_start;
-                    if (my_row) {
-                        parse_dense_matrix<Index_>(obj, current, 0, true, p.second->data, chunk_len, my_non_target_length);
-                    } else {
-                        parse_dense_matrix<Index_>(obj, 0, current, false, p.second->data, my_non_target_length, chunk_len);
+                auto create_primary_extract = [&](const std::size_t first, const std::size_t last) -> pybind11::array_t<Index_> {
+                    Index_ total_len = 0;
+                    for (auto x = first; x < last; ++x) {
+                        total_len += chunk_length(x);
                     }
-                    current += chunk_len;
+
+                    pybind11::array_t<Index_> primary_extract(total_len); // known to be safe, from the constructor.
+                    auto pptr = static_cast<Index_*>(primary_extract.request().ptr);
+                    Index_ current = 0;
+                    for (auto x = first; x < last; ++x) {
+                        const Index_ chunk_start = my_chunk_ticks[to_populate[x].first];
+                        const Index_ chunk_len = chunk_length(x);
+                        const auto start = pptr + current;
+                        std::iota(start, start + chunk_len, chunk_start);
+                        current += chunk_len;
+                    }
+                    return primary_extract;
+                };
+
+                const bool use_chunks = my_options.dense_chunk_extractor.has_value();
+
+                // For multiple chunks, the backend writes into our staging buffer, from which each chunk is copied into its slab.
+                // Each chunk is contiguous in the staging buffer, so this avoids both the allocation of a new NumPy array and the parsing of its contents.
+                // We skip this if the calls are to be kept in flight on an executor, as they can't all share the same buffer.
+                if (my_use_out && !use_chunks && !my_options.executor.has_value()) {
+                    extract_within_limit(
+                        my_options.memory,
+                        to_populate.size(),
+                        chunk_length,
+                        sizeof(CachedValue_) * static_cast<std::size_t>(my_non_target_length),
+                        my_max_batch_length,
+                        [&](const std::size_t first, const std::size_t last) -> void {
+                            auto primary_extract = create_primary_extract(first, last);
+                            const Index_ total_len = primary_extract.size();
+                            const std::size_t staging_size = sanisizer::product<std::size_t>(total_len, my_non_target_length);
+                            if (my_staging.size() < staging_size) {
+                                sanisizer::resize(my_staging, staging_size);
+                                my_staging_memory.resize(sizeof(CachedValue_) * staging_size);
+                            }
+
+                            (*my_extract_args)[static_cast<int>(!my_row)] = std::move(primary_extract);
+                            extract_dense_slab(my_dense_extractor, my_matrix, my_options, *my_extract_args, my_use_out, my_row, my_staging.data(), total_len, my_non_target_length);
+
+                            std::size_t offset = 0;
+                            for (auto x = first; x < last; ++x) {
+                                const std::size_t chunk_size = static_cast<std::size_t>(chunk_length(x)) * static_cast<std::size_t>(my_non_target_length); // no overflow as it fits in the staging buffer.
+                                std::copy_n(my_staging.data() + offset, chunk_size, to_populate[x].second->data);
+                                offset += chunk_size;
+                            }
+                        }
+                    );
+                    return;
                 }
 
+                extract_in_flight_within_limit(
+                    (use_chunks ? *(my_options.dense_chunk_extractor) : my_dense_extractor),
+                    my_options,
+                    to_populate.size(),
+                    chunk_length,
+                    sizeof(CachedValue_) * static_cast<std::size_t>(my_non_target_length),
+                    my_max_batch_length,
+                    [&](const std::size_t first, const std::size_t last) -> pybind11::tuple {
+                        if (use_chunks) {
+                            return create_chunk_args(my_matrix, to_populate, first, last, my_chunk_ticks, *my_extract_args, my_row);
+                        }
+                        return pybind11::make_tuple(my_matrix, create_extract_args(*my_extract_args, my_row, create_primary_extract(first, last)));
+                    },
+                    [&](const std::size_t first, const std::size_t last, const pybind11::object& obj) -> void {
+                        if (use_chunks) {
+                            auto parts = split_chunk_results(obj, last - first);
+                            if (parts.has_value()) {
+                                for (auto x = first; x < last; ++x) {
+                                    const auto& p = to_populate[x];
+                                    const Index_ chunk_len = my_chunk_ticks[p.first + 1] - my_chunk_ticks[p.first];
+                                    const pybind11::object part((*parts)[x - first]);
+                                    if (my_row) {
+                                        parse_dense_matrix<Index_>(part, 0, 0, true, p.second->data, chunk_len, my_non_target_length);
+                                    } else {
+                                        parse_dense_matrix<Index_>(part, 0, 0, false, p.second->data, my_non_target_length, chunk_len);
+                                    }
+                                }
+                                return;
+                            }
+                        }
+
+                        Index_ current = 0;
+                        for (auto x = first; x < last; ++x) {
+                            const auto& p = to_populate[x];
+                            const auto chunk_start = my_chunk_ticks[p.first];
+                            const Index_ chunk_len = my_chunk_ticks[p.first + 1] - chunk_start;
+                            if (my_row) {
+                                parse_dense_matrix<Index_>(obj, current, 0, true, p.second->data, chunk_len, my_non_target_length);
+                            } else {
+                                parse_dense_matrix<Index_>(obj, 0, current, false, p.second->data, my_non_target_length, chunk_len);
+                            }
+                            current += chunk_len;
+                        }
+                    }
+                );
+
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
                 });
 #endif
@@ -291,13 +677,13 @@ public:
         );
 
         auto shift = sanisizer::product_unsafe<std::size_t>(my_non_target_length, res.second);
-        std::copy_n(res.first->data + shift, my_non_target_length, buffer);
+        return fetch_from_cache(res.first->data + shift, my_non_target_length, buffer);
     }
 };
 
 template<bool solo_, bool oracle_, typename Index_, typename CachedValue_>
 using DenseCore = typename std::conditional<solo_,
-    SoloDenseCore<oracle_, Index_>,
+    SoloDenseCore<oracle_, Index_, CachedValue_>,
     typename std::conditional<oracle_,
         OracularDenseCore<Index_, CachedValue_>,
         MyopicDenseCore<Index_, CachedValue_>
@@ -315,16 +701,18 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& dense_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         const Index_ non_target_dim,
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats
     ) :
         my_core(
             matrix,
             dense_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array<Index_>(0, non_target_dim),
             ticks,
@@ -338,8 +726,7 @@ private:
 
 public:
     const Value_* fetch(Index_ i, Value_* buffer) {
-        my_core.fetch_raw(i, buffer);
-        return buffer;
+        return my_core.fetch_raw(i, buffer);
     }
 };
 
@@ -350,17 +737,19 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& dense_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         const Index_ block_start,
         const Index_ block_length,
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats
     ) :
         my_core(
             matrix,
             dense_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array<Index_>(block_start, block_length),
             ticks,
@@ -374,8 +763,7 @@ private:
 
 public:
     const Value_* fetch(Index_ i, Value_* buffer) {
-        my_core.fetch_raw(i, buffer);
-        return buffer;
+        return my_core.fetch_raw(i, buffer);
     }
 };
 
@@ -386,16 +774,18 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& dense_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         tatami::VectorPtr<Index_> indices_ptr,
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats
     ) :
         my_core(
             matrix,
             dense_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array(*indices_ptr),
             ticks,
@@ -409,8 +799,7 @@ private:
 
 public:
     const Value_* fetch(Index_ i, Value_* buffer) {
-        my_core.fetch_raw(i, buffer);
-        return buffer;
+        return my_core.fetch_raw(i, buffer);
     }
 };
 
@@ -0,0 +1,87 @@
+#ifndef TATAMI_PYTHON_GRANULARITY_HPP
+#define TATAMI_PYTHON_GRANULARITY_HPP
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+namespace tatami_python {
+
+// Whether it is worth adapting the granularity at all, which is only the case if each slab contains more than one row/column.
+// Both the dense and sparse cores use the same criterion, so that they switch at the same times for the same access pattern.
+inline bool worth_adapting_granularity(const bool enabled, const std::size_t slab_size_in_elements, const std::size_t non_target_length) {
+    return enabled && slab_size_in_elements > non_target_length;
+}
+
+// Decides whether a myopic core should fetch whole chunks or individual rows/columns, based on the observed reuse of each chunk.
+// In chunk mode, we count the number of chunks that had to be loaded in each window of requests.
+// If most requests trigger a load, each chunk is used about once and fetching the rest of the chunk is a waste, so we switch to element mode.
+// In element mode, we keep track of the chunks of recent requests to estimate the hit rate if we were to cache whole chunks.
+// If this is high enough, we switch back to chunk mode.
+template<typename Index_>
+class GranularityPolicy {
+public:
+    GranularityPolicy(const std::size_t max_slabs_in_cache) :
+        my_history(std::min(std::max(max_slabs_in_cache, static_cast<std::size_t>(1)), max_history)) {}
+
+private:
+    static constexpr std::size_t window = 64;
+    static constexpr std::size_t max_history = 64;
+
+    bool my_use_chunks = true;
+    std::size_t my_requests = 0;
+    std::size_t my_events = 0;
+
+    // Ring buffer of recently requested chunks in element mode, approximating the contents of the cache.
+    std::vector<Index_> my_history;
+    std::size_t my_history_used = 0;
+    std::size_t my_history_next = 0;
+
+    bool finish_window() {
+        ++my_requests;
+        if (my_requests < window) {
+            return false;
+        }
+
+        // In chunk mode, loading a chunk for more than half of all requests means that each chunk is used less than twice on average.
+        // In element mode, we switch back if more than half of all requests would have been served from cached chunks.
+        const bool flip = (my_events * 2 > window);
+
+        my_requests = 0;
+        my_events = 0;
+        if (flip) {
+            my_use_chunks = !my_use_chunks;
+            my_history_used = 0;
+            my_history_next = 0;
+        }
+        return flip;
+    }
+
+public:
+    bool use_chunks() const {
+        return my_use_chunks;
+    }
+
+    // Returns true if the policy switched to element mode.
+    bool record_chunk_request(const bool loaded) {
+        my_events += loaded;
+        return finish_window();
+    }
+
+    // Returns true if the policy switched to chunk mode.
+    bool record_element_request(const Index_ chunk) {
+        const auto hEnd = my_history.begin() + my_history_used;
+        if (std::find(my_history.begin(), hEnd, chunk) != hEnd) {
+            ++my_events;
+        } else {
+            my_history[my_history_next] = chunk;
+            my_history_next = (my_history_next + 1) % my_history.size();
+            my_history_used = std::min(my_history_used + 1, my_history.size());
+        }
+        return finish_window();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef TATAMI_PYTHON_HDF5_HPP
+#define TATAMI_PYTHON_HDF5_HPP
+
+#include "pybind11/pybind11.h"
+#include "pybind11/numpy.h"
+#include "tatami/tatami.hpp"
+
+#include "parallelize.hpp"
+
+// Optionally serializing calls to the HDF5 library with the same lock as calls to Python,
+// as h5py may be calling the (non-thread-safe) HDF5 library in other threads.
+#if defined(TATAMI_PYTHON_PARALLELIZE_UNKNOWN) && defined(TATAMI_PYTHON_HDF5_SHARED_LOCK)
+#ifndef TATAMI_HDF5_PARALLEL_LOCK
+#define TATAMI_HDF5_PARALLEL_LOCK TATAMI_PYTHON_SERIALIZE
+#endif
+#endif
+
+#include "tatami_hdf5/tatami_hdf5.hpp"
+
+#include "UnknownMatrix.hpp"
+#include "utils.hpp"
+
+#include <memory>
+#include <string>
+
+/**
+ * @file hdf5.hpp
+ * @brief Open HDF5-backed Python matrices with the HDF5 C library.
+ */
+
+namespace tatami_python {
+
+/**
+ * @cond
+ */
+inline pybind11::object import_if_available(const char* name) {
+    try {
+        return pybind11::module::import(name);
+    } catch (pybind11::error_already_set& e) {
+        if (e.matches(PyExc_ImportError)) {
+            return pybind11::none();
+        }
+        throw;
+    }
+}
+
+inline bool is_instance_of(const pybind11::object& x, const pybind11::object& module, const char* cls) {
+    if (module.is_none()) {
+        return false;
+    }
+    auto type = pybind11::getattr(module, cls, pybind11::none());
+    return !type.is_none() && pybind11::isinstance(x, type);
+}
+
+inline bool has_hdf5_numeric_dtype(const pybind11::object& x) {
+    const auto kind = pybind11::dtype(x.attr("dtype")).kind();
+    return kind == 'i' || kind == 'u' || kind == 'f';
+}
+/**
+ * @endcond
+ */
+
+/**
+ * Open a HDF5-backed Python matrix as a native **tatami_hdf5** matrix, bypassing Python for all data extraction.
+ * The following objects are recognized:
+ *
+ * - A 2-dimensional `h5py.Dataset` from a file that was opened in read-only mode.
+ *   This is opened as a `tatami_hdf5::DenseMatrix`, where the rows of the matrix are the first dimension of the dataset.
+ * - A 2-dimensional `Hdf5DenseArraySeed` from the **hdf5array** package, which is also opened as a `tatami_hdf5::DenseMatrix`.
+ *   If its `native_order` is false, the dataset is transposed.
+ * - A `Hdf5CompressedSparseMatrixSeed` from the **hdf5array** package,
+ *   which is opened as a `tatami_hdf5::CompressedSparseMatrix` from the `data`, `indices` and `indptr` datasets in its group.
+ * .
+ * The file is re-opened by the HDF5 C library, so it should not be modified by Python while the matrix is in use.
+ *
+ * By default, calls to the HDF5 library are serialized with **tatami_hdf5**'s own lock (see its documentation for details), which does not involve the GIL.
+ * If both `TATAMI_PYTHON_PARALLELIZE_UNKNOWN` and `TATAMI_PYTHON_HDF5_SHARED_LOCK` are defined, `TATAMI_HDF5_PARALLEL_LOCK` is instead defined to `TATAMI_PYTHON_SERIALIZE` (unless it was already defined by the user).
+ * This serializes calls to the HDF5 library with calls to Python, which is necessary if **h5py** might be used in other threads at the same time.
+ * For this to take effect, this header should be included before any other inclusion of the **tatami_hdf5** headers.
+ *
+ * This function is only used by `translate_delayed()`; an `UnknownMatrix` does not check whether its seed is backed by HDF5.
+ * Callers that construct an `UnknownMatrix` directly can call this function first and only fall back to the `UnknownMatrix` if NULL is returned.
+ *
+ * This function is only available if the `TATAMI_PYTHON_USE_HDF5` macro is defined.
+ * It should only be called when the current thread is holding the GIL.
+ *
+ * @tparam Value_ Numeric type of data value for the interface.
+ * @tparam Index_ Integer type for the row/column indices, for the interface.
+ * @tparam CachedValue_ Numeric type of data value for the cache.
+ * @tparam CachedIndex_ Integer type for the row/column indices for the cache.
+ *
+ * @param seed A matrix-like Python object.
+ * @param opt Extraction options.
+ * Only `UnknownMatrixOptions::maximum_cache_size` and `UnknownMatrixOptions::require_minimum_cache` are used.
+ * The latter is ignored for `Hdf5CompressedSparseMatrixSeed`s, as `tatami_hdf5::CompressedSparseMatrixOptions` has no equivalent option.
+ *
+ * @return Pointer to the native matrix, or NULL if `seed` is not recognized.
+ * In the latter case, the caller should fall back to an `UnknownMatrix`.
+ */
+template<typename Value_, typename Index_, typename CachedValue_ = Value_, typename CachedIndex_ = Index_>
+std::shared_ptr<const tatami::Matrix<Value_, Index_> > open_hdf5_seed(const pybind11::object& seed, const UnknownMatrixOptions& opt) {
+    auto h5py = import_if_available("h5py");
+    if (is_instance_of(seed, h5py, "Dataset")) {
+        if (seed.attr("ndim").template cast<int>() != 2 || !has_hdf5_numeric_dtype(seed)) {
+            return nullptr;
+        }
+
+        // Files that are open for writing in Python may have unflushed changes or be locked.
+        auto file = seed.attr("file");
+        if (file.attr("mode").template cast<std::string>() != "r") {
+            return nullptr;
+        }
+
+        tatami_hdf5::DenseMatrixOptions hopt;
+        hopt.maximum_cache_size = opt.maximum_cache_size;
+        hopt.require_minimum_cache = opt.require_minimum_cache;
+        return std::make_shared<tatami_hdf5::DenseMatrix<Value_, Index_, CachedValue_> >(
+            file.attr("filename").template cast<std::string>(),
+            seed.attr("name").template cast<std::string>(),
+            false,
+            hopt
+        );
+    }
+
+    auto hdf5array = import_if_available("hdf5array");
+    if (is_instance_of(seed, hdf5array, "Hdf5DenseArraySeed")) {
+        if (seed.attr("ndim").template cast<int>() != 2 || !has_hdf5_numeric_dtype(seed)) {
+            return nullptr;
+        }
+
+        tatami_hdf5::DenseMatrixOptions hopt;
+        hopt.maximum_cache_size = opt.maximum_cache_size;
+        hopt.require_minimum_cache = opt.require_minimum_cache;
+        return std::make_shared<tatami_hdf5::DenseMatrix<Value_, Index_, CachedValue_> >(
+            seed.attr("path").template cast<std::string>(),
+            seed.attr("name").template cast<std::string>(),
+            !seed.attr("native_order").template cast<bool>(),
+            hopt
+        );
+    }
+
+    if (is_instance_of(seed, hdf5array, "Hdf5CompressedSparseMatrixSeed")) {
+        if (seed.attr("shape").template cast<pybind11::tuple>().size() != 2 || !has_hdf5_numeric_dtype(seed)) {
+            return nullptr;
+        }
+
+        const auto shape = get_shape<Index_>(seed);
+        const auto group = seed.attr("group_name").template cast<std::string>();
+        tatami_hdf5::CompressedSparseMatrixOptions hopt;
+        hopt.maximum_cache_size = opt.maximum_cache_size;
+        return std::make_shared<tatami_hdf5::CompressedSparseMatrix<Value_, Index_, CachedValue_, CachedIndex_> >(
+            shape.first,
+            shape.second,
+            seed.attr("path").template cast<std::string>(),
+            group + "/data",
+            group + "/indices",
+            group + "/indptr",
+            !seed.attr("by_column").template cast<bool>(),
+            hopt
+        );
+    }
+
+    return nullptr;
+}
+
+}
+
+#endif
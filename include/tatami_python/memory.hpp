@@ -0,0 +1,158 @@
+#ifndef TATAMI_PYTHON_MEMORY_HPP
+#define TATAMI_PYTHON_MEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+namespace tatami_python {
+
+// Accounting of the bytes held by all extractors of an UnknownMatrix, i.e., slab caches, staging buffers, pinned NumPy arrays and in-flight results.
+// This is updated by each core via TrackedMemory, so it is atomic as the cores may be used in different threads.
+class MemoryTracker {
+private:
+    std::atomic<std::size_t> my_current{0};
+    std::atomic<std::size_t> my_peak{0};
+    std::size_t my_limit = 0;
+
+public:
+    void acquire(const std::size_t bytes) {
+        const std::size_t now = my_current.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::size_t peak = my_peak.load(std::memory_order_relaxed);
+        while (now > peak && !my_peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+    }
+
+    void release(const std::size_t bytes) {
+        my_current.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    std::size_t current() const {
+        return my_current.load(std::memory_order_relaxed);
+    }
+
+    std::size_t peak() const {
+        return my_peak.load(std::memory_order_relaxed);
+    }
+
+    void reset_peak() {
+        my_peak.store(current(), std::memory_order_relaxed);
+    }
+
+    // Zero means that there is no limit. This should only be set before any extractors are created.
+    void set_limit(const std::size_t limit) {
+        my_limit = limit;
+    }
+
+    std::size_t limit() const {
+        return my_limit;
+    }
+
+    // Number of bytes that can be acquired without exceeding the limit.
+    std::size_t available() const {
+        if (my_limit == 0) {
+            return std::numeric_limits<std::size_t>::max();
+        }
+        const auto now = current();
+        return (now >= my_limit ? 0 : my_limit - now);
+    }
+};
+
+// Bytes held by a single core (or a single call into Python), which are returned to the tracker upon destruction.
+class TrackedMemory {
+public:
+    TrackedMemory(MemoryTracker& tracker, const std::size_t bytes = 0) : my_tracker(&tracker), my_bytes(bytes) {
+        tracker.acquire(bytes);
+    }
+
+    TrackedMemory(TrackedMemory&& other) noexcept : my_tracker(other.my_tracker), my_bytes(other.my_bytes) {
+        other.my_tracker = NULL;
+    }
+
+    TrackedMemory& operator=(TrackedMemory&& other) noexcept {
+        if (this != &other) {
+            release();
+            my_tracker = other.my_tracker;
+            my_bytes = other.my_bytes;
+            other.my_tracker = NULL;
+        }
+        return *this;
+    }
+
+    TrackedMemory(const TrackedMemory&) = delete;
+    TrackedMemory& operator=(const TrackedMemory&) = delete;
+
+    ~TrackedMemory() {
+        release();
+    }
+
+private:
+    MemoryTracker* my_tracker;
+    std::size_t my_bytes;
+
+    void release() {
+        if (my_tracker) {
+            my_tracker->release(my_bytes);
+            my_tracker = NULL;
+        }
+    }
+
+public:
+    // Update the number of held bytes, e.g., after a buffer is reallocated.
+    void resize(const std::size_t bytes) {
+        if (bytes > my_bytes) {
+            my_tracker->acquire(bytes - my_bytes);
+        } else {
+            my_tracker->release(my_bytes - bytes);
+        }
+        my_bytes = bytes;
+    }
+
+    std::size_t bytes() const {
+        return my_bytes;
+    }
+};
+
+// Splits a batch of 'num_chunks' chunks into groups of consecutive chunks, such that each group spans no more than 'max_length' rows/columns of the target dimension,
+// and the results of each group fit within the tracker's limit.
+// 'length(x)' should return the length of the x-th chunk along the target dimension, and 'target_bytes' should be the size of the result for each row/column.
+// 'extract(first, last)' should then extract the chunks in [first, last); the result of each group is tracked while it is being extracted.
+// Each group contains at least one chunk, so the limits will still be exceeded if a single chunk does not fit.
+// This is only used for the batches of the oracular cores; the myopic and solo cores request one chunk (or row/column) at a time, which cannot be split anyway.
+template<class Length_, class Extract_>
+void extract_within_limit(
+    MemoryTracker& tracker,
+    const std::size_t num_chunks,
+    Length_ length,
+    const std::size_t target_bytes,
+    const std::size_t max_length,
+    Extract_ extract
+) {
+    std::size_t first = 0;
+    while (first < num_chunks) {
+        const std::size_t available = tracker.available();
+        std::size_t last = first, total_length = 0, total_bytes = 0;
+        do {
+            const std::size_t next_length = length(last);
+            const std::size_t next_bytes = next_length * target_bytes; // no overflow as the slabs for this chunk have already been allocated.
+            if (last > first) {
+                if (total_length > max_length || next_length > max_length - total_length) {
+                    break;
+                }
+                if (total_bytes > available || next_bytes > available - total_bytes) {
+                    break;
+                }
+            }
+            total_length += next_length;
+            total_bytes += next_bytes;
+            ++last;
+        } while (last < num_chunks);
+
+        TrackedMemory in_flight(tracker, total_bytes);
+        extract(first, last);
+        first = last;
+    }
+}
+
+}
+
+#endif
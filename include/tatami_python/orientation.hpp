@@ -0,0 +1,113 @@
+#ifndef TATAMI_PYTHON_ORIENTATION_HPP
+#define TATAMI_PYTHON_ORIENTATION_HPP
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @file orientation.hpp
+ * @brief Cost model for the preferred iteration dimension.
+ */
+
+namespace tatami_python {
+
+/**
+ * @brief Costs of the operations involved in extracting a chunk from Python.
+ *
+ * These are used by `UnknownMatrix` to estimate the cost of fetching a single row or column from a cold cache, see `estimate_fetch_cost()`.
+ * The defaults are rough guesses in nanoseconds for an in-memory backend; only their ratios matter.
+ */
+struct OrientationCosts {
+    /**
+     * Fixed overhead of each call to `extract_dense_array()` or `extract_sparse_array()`.
+     */
+    double call = 20000;
+
+    /**
+     * Cost of transferring each byte of the extracted chunk.
+     */
+    double byte = 0.25;
+
+    /**
+     * Cost of parsing each leaf of a `SparseNdarray`, i.e., each column of the extracted submatrix.
+     * Only used for sparse matrices.
+     */
+    double leaf = 20;
+};
+
+/**
+ * @tparam Index_ Integer type for the row/column indices.
+ * @param ticks Chunk boundaries along the dimension of interest.
+ * This should start at zero, be strictly increasing and end at the extent of the dimension.
+ * @return Expected length of the chunk containing a randomly chosen row/column, i.e., the sum of squared chunk lengths divided by the extent.
+ * For irregular chunks, this is larger than the average chunk length as longer chunks are more likely to be chosen.
+ */
+template<typename Index_>
+double expected_chunk_length(const std::vector<Index_>& ticks) {
+    if (ticks.size() < 2 || ticks.back() == 0) {
+        return 0;
+    }
+    double total = 0;
+    for (std::size_t i = 1, end = ticks.size(); i < end; ++i) {
+        const double length = ticks[i] - ticks[i - 1];
+        total += length * length;
+    }
+    return total / static_cast<double>(ticks.back());
+}
+
+/**
+ * Estimate the cost of fetching a single row/column from a cold cache.
+ * This involves one call to Python that extracts the chunk containing the row/column across the full extent of the other dimension.
+ * The estimate captures the read amplification of large chunks along the target dimension, as well as the size of the cache that is required to avoid re-reading each chunk.
+ * For dense matrices with regular chunks, the cheaper dimension is the one that requires fewer chunks for each row/column.
+ * For sparse matrices, the per-leaf cost is asymmetric as each row involves one leaf per column of the matrix,
+ * so columns may be preferred even if both dimensions require the same number of chunks.
+ *
+ * @tparam Index_ Integer type for the row/column indices.
+ * @param costs Costs of each operation.
+ * @param target_ticks Chunk boundaries along the target dimension, see `expected_chunk_length()`.
+ * @param non_target_extent Extent of the other dimension.
+ * @param row Whether rows are being fetched.
+ * @param element_size Size of each element of the chunk, in bytes.
+ * For sparse matrices, this should include the size of the index.
+ * @param sparse Whether the matrix is sparse.
+ * As the density is unknown, the transfer cost assumes that all elements are non-zero.
+ *
+ * @return Estimated cost of fetching a row/column.
+ */
+template<typename Index_>
+double estimate_fetch_cost(
+    const OrientationCosts& costs,
+    const std::vector<Index_>& target_ticks,
+    const Index_ non_target_extent,
+    const bool row,
+    const std::size_t element_size,
+    const bool sparse
+) {
+    const double length = expected_chunk_length(target_ticks);
+    const double non_target = non_target_extent;
+    double output = costs.call + costs.byte * static_cast<double>(element_size) * length * non_target;
+    if (sparse) {
+        // Each SparseNdarray has one leaf per column of the extracted submatrix.
+        output += costs.leaf * (row ? non_target : length);
+    }
+    return output;
+}
+
+/**
+ * @param row_cost Cost of fetching a row.
+ * @param column_cost Cost of fetching a column.
+ * @return Proportion of the total cost that is attributable to columns, i.e., the extent to which rows are preferred.
+ * This is equal to 0.5 if both costs are zero.
+ */
+inline double orientation_proportion(const double row_cost, const double column_cost) {
+    const double total = row_cost + column_cost;
+    if (total <= 0) {
+        return 0.5;
+    }
+    return column_cost / total;
+}
+
+}
+
+#endif
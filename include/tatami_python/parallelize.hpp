@@ -12,13 +12,26 @@
 #include "pybind11/pybind11.h"
 #include "subpar/subpar.hpp"
 
+#include "partition.hpp"
+
 #include <optional>
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <algorithm>
 
 #ifndef TATAMI_PYTHON_SERIALIZE
 /**
  * Macro function that accepts a function object and executes it in a serial context.
  */
 #define TATAMI_PYTHON_SERIALIZE ::tatami_python::lock
+/**
+ * @cond
+ */
+#define TATAMI_PYTHON_DEFAULT_SERIALIZE
+/**
+ * @endcond
+ */
 #endif 
 
 /**
@@ -55,17 +68,232 @@ void parallelize(const Function_ fun, const Index_ tasks, int threads) {
     subpar::parallelize_range(threads, tasks, std::move(fun));
 }
 
+/**
+ * Variant of `parallelize()` where the tasks are partitioned along chunk boundaries, see `partition_chunks()` for details.
+ * This avoids fetching the same chunk in multiple threads when the range for each thread would otherwise cut through a chunk.
+ * It also balances the load across threads according to the (estimated) costs of the chunks, if these are supplied.
+ * Like `parallelize()`, the Python GIL is released before any parallel work is performed.
+ *
+ * @tparam Function_ Function to be applied to a contiguous range of tasks, see `parallelize()` for details.
+ * @tparam Index_ Integer type for the number of tasks.
+ * @tparam Cost_ Numeric type for the cost of each chunk.
+ *
+ * @param fun Function that executes a contiguous range of tasks.
+ * @param ticks Chunk boundaries along the dimension to be iterated over, typically from `UnknownMatrix::chunk_ticks()`.
+ * @param threads Number of threads.
+ * @param costs Pointer to an array of per-chunk costs, see `partition_chunks()` for details.
+ */
+template<class Function_, class Index_, typename Cost_ = double>
+void parallelize_chunks(const Function_ fun, const std::vector<Index_>& ticks, int threads, const Cost_* const costs = NULL) {
+    const auto boundaries = partition_chunks(ticks, threads, costs);
+    if (boundaries.size() < 2) {
+        return;
+    }
+    const int num_ranges = boundaries.size() - 1;
+
+    std::optional<pybind11::gil_scoped_release> ungil;
+    if (PyGILState_Check()) {
+        ungil.emplace();
+    }
+    subpar::parallelize_simple(num_ranges, [&](const int r) -> void {
+        fun(r, boundaries[r], static_cast<Index_>(boundaries[r + 1] - boundaries[r]));
+    });
+}
+
+/**
+ * @cond
+ */
+// Each worker owns a contiguous range of tasks, taking tasks from the front of its own range.
+// Idle workers steal the back half of the largest remaining range from another worker.
+class StealingQueues {
+public:
+    StealingQueues(const std::size_t num_tasks, const int num_workers) : my_queues(num_workers) {
+        for (int w = 0; w < num_workers; ++w) {
+            auto& current = my_queues[w];
+            current.start = (num_tasks * w) / num_workers; 
+            current.end = (num_tasks * (w + 1)) / num_workers; 
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::size_t start = 0, end = 0;
+    };
+    std::vector<Queue> my_queues;
+
+public:
+    bool next(const int worker, std::size_t& task) {
+        auto& mine = my_queues[worker];
+        {
+            std::lock_guard<std::mutex> lck(mine.lock);
+            if (mine.start < mine.end) {
+                task = mine.start;
+                ++mine.start;
+                return true;
+            }
+        }
+
+        while (true) {
+            std::size_t best_remaining = 0;
+            int best_victim = 0;
+            const int num_workers = my_queues.size();
+            for (int w = 0; w < num_workers; ++w) {
+                if (w == worker) {
+                    continue;
+                }
+                auto& other = my_queues[w];
+                std::lock_guard<std::mutex> lck(other.lock);
+                const auto remaining = other.end - other.start;
+                if (remaining > best_remaining) {
+                    best_remaining = remaining;
+                    best_victim = w;
+                }
+            }
+            if (best_remaining == 0) {
+                return false;
+            }
+
+            std::size_t stolen_start, stolen_end;
+            {
+                auto& victim = my_queues[best_victim];
+                std::lock_guard<std::mutex> lck(victim.lock);
+                if (victim.start == victim.end) {
+                    continue; // someone else got there first, so we just try again.
+                }
+                stolen_end = victim.end;
+                stolen_start = victim.end - (victim.end - victim.start + 1) / 2;
+                victim.end = stolen_start;
+            }
+
+            task = stolen_start;
+            std::lock_guard<std::mutex> lck(mine.lock);
+            mine.start = stolen_start + 1;
+            mine.end = stolen_end;
+            return true;
+        }
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * Variant of `parallelize()` that uses work-stealing to schedule groups of chunks across threads.
+ * Each group of consecutive chunks is treated as a separate task, and each thread initially receives a contiguous range of tasks.
+ * Once a thread has finished its own tasks, it steals the later half of the remaining tasks from the thread with the most remaining tasks.
+ * This mitigates the variability in the cost of each chunk, e.g., due to contention for the GIL or variable latency in the Python backend,
+ * which would otherwise leave some threads idle with static partitioning.
+ * Like `parallelize()`, the Python GIL is released before any parallel work is performed.
+ *
+ * @tparam Function_ Function to be applied to a contiguous range of tasks, see `parallelize()` for details.
+ * Each call to this function will process a single group of chunks, so it should create a new extractor (typically with a `tatami::ConsecutiveOracle`) for the supplied range.
+ * The same thread may call this function multiple times, but any two calls will never be executed concurrently with the same thread number.
+ * @tparam Index_ Integer type for the number of tasks.
+ *
+ * @param fun Function that executes a contiguous range of tasks.
+ * @param ticks Chunk boundaries along the dimension to be iterated over, typically from `UnknownMatrix::chunk_ticks()`.
+ * @param threads Number of threads.
+ * @param chunks_per_task Number of consecutive chunks in each task.
+ * Larger values reduce the overhead of creating a new extractor for each task, at the cost of coarser load balancing.
+ */
+template<class Function_, class Index_>
+void parallelize_stealing(const Function_ fun, const std::vector<Index_>& ticks, int threads, std::size_t chunks_per_task = 1) {
+    if (ticks.size() < 2) {
+        return;
+    }
+    const auto num_chunks = ticks.size() - 1;
+    if (chunks_per_task == 0) {
+        chunks_per_task = 1;
+    }
+    const std::size_t num_tasks = num_chunks / chunks_per_task + (num_chunks % chunks_per_task > 0);
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (static_cast<std::size_t>(threads) > num_tasks) {
+        threads = num_tasks;
+    }
+
+    StealingQueues queues(num_tasks, threads);
+    std::optional<pybind11::gil_scoped_release> ungil;
+    if (PyGILState_Check()) {
+        ungil.emplace();
+    }
+
+    subpar::parallelize_simple(threads, [&](const int w) -> void {
+        std::size_t task;
+        while (queues.next(w, task)) {
+            const auto first = task * chunks_per_task;
+            const auto last = std::min(first + chunks_per_task, num_chunks);
+            fun(w, ticks[first], static_cast<Index_>(ticks[last] - ticks[first]));
+        }
+    });
+}
+
+/**
+ * This function is only available if `TATAMI_PYTHON_PARALLELIZE_UNKNOWN` is defined.
+ * It is always false unless **tatami_python** is compiled against a free-threaded build of CPython (PEP 703), i.e., `Py_GIL_DISABLED` is defined.
+ * Even in free-threaded builds, the GIL may be enabled at runtime, e.g., by `PYTHON_GIL=1` or by importing an extension that does not support free-threading.
+ * The result is computed on the first call and cached for all subsequent calls, so the first call should be performed in a serial context,
+ * e.g., in the `UnknownMatrix` constructor.
+ *
+ * @return Whether the GIL is disabled in the current interpreter.
+ */
+inline bool gil_disabled() {
+#ifdef Py_GIL_DISABLED
+    static const bool disabled = []() -> bool {
+        std::optional<pybind11::gil_scoped_acquire> gil;
+        if (!PyGILState_Check()) {
+            gil.emplace();
+        }
+        auto sys = pybind11::module::import("sys");
+        if (!pybind11::hasattr(sys, "_is_gil_enabled")) {
+            return true;
+        }
+        return !(sys.attr("_is_gil_enabled")().template cast<bool>());
+    }();
+    return disabled;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @cond
+ */
+inline std::mutex& serial_mutex() {
+    static std::mutex mut;
+    return mut;
+}
+/**
+ * @endcond
+ */
+
 /**
  * This function is only available if `TATAMI_PYTHON_PARALLELIZE_UNKNOWN` is defined.
  * Applications can override this by defining a `TATAMI_PYTHON_SERIALIZE` function-like macro,
  * which should accept a function object and execute it in some serial context.
  *
+ * If the GIL is disabled (see `gil_disabled()`), this function emulates the GIL with a global mutex,
+ * so that calls to the Python API are still serialized for backends that are not thread-safe.
+ *
  * @tparam Function_ Function that accepts no arguments.
  * @param fun Function to be evaluated after the GIL is acquired.
  * This typically involves calls to the Python interpreter or API.
  */
 template<typename Function_>
 void lock(Function_ fun) {
+    std::unique_lock<std::mutex> serial(serial_mutex(), std::defer_lock);
+    if (gil_disabled()) {
+        // Acquiring the mutex while detached from the interpreter, otherwise we could block a stop-the-world pause.
+        if (PyGILState_Check()) {
+            pybind11::gil_scoped_release ungil;
+            serial.lock();
+        } else {
+            serial.lock();
+        }
+    }
+
     std::optional<pybind11::gil_scoped_acquire> gil;
     if (!PyGILState_Check()) {
         gil.emplace();
@@ -73,6 +301,44 @@ void lock(Function_ fun) {
     fun();
 }
 
+/**
+ * This function is only available if `TATAMI_PYTHON_PARALLELIZE_UNKNOWN` is defined.
+ * It attaches the current thread to the Python interpreter, without any further serialization if the GIL is disabled (see `gil_disabled()`).
+ * This allows multiple threads to call into a thread-safe backend concurrently on free-threaded builds of CPython.
+ * If the GIL is enabled, this is equivalent to `lock()`.
+ *
+ * @tparam Function_ Function that accepts no arguments.
+ * @param fun Function to be evaluated after attaching to the interpreter.
+ * This typically involves calls to the Python interpreter or API.
+ */
+template<typename Function_>
+void attach(Function_ fun) {
+    std::optional<pybind11::gil_scoped_acquire> gil;
+    if (!PyGILState_Check()) {
+        gil.emplace();
+    }
+    fun();
+}
+
+/**
+ * @cond
+ */
+// A user-defined TATAMI_PYTHON_SERIALIZE may need to coordinate with other code (e.g., a lock shared with the application),
+// so we must not bypass it with attach(); the user's macro is responsible for deciding whether to serialize.
+template<typename Function_>
+void serialize([[maybe_unused]] const bool thread_safe, Function_ fun) {
+#ifdef TATAMI_PYTHON_DEFAULT_SERIALIZE
+    if (thread_safe && gil_disabled()) {
+        attach(std::move(fun));
+        return;
+    }
+#endif
+    TATAMI_PYTHON_SERIALIZE(std::move(fun));
+}
+/**
+ * @endcond
+ */
+
 }
 
 /**
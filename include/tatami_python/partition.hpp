@@ -0,0 +1,102 @@
+#ifndef TATAMI_PYTHON_PARTITION_HPP
+#define TATAMI_PYTHON_PARTITION_HPP
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * @file partition.hpp
+ * @brief Partition a dimension into chunk-aligned ranges.
+ */
+
+namespace tatami_python {
+
+/**
+ * Partition a dimension into contiguous ranges for parallel processing, where the range boundaries are aligned to the chunk boundaries.
+ * This ensures that no chunk is fetched by more than one thread, e.g., when each thread iterates over its range with an oracle-aware extractor.
+ * Ranges are also chosen to balance the total cost of the chunks across threads.
+ *
+ * @tparam Index_ Integer type for the row/column indices.
+ * @tparam Cost_ Numeric type for the cost of each chunk.
+ *
+ * @param ticks Chunk boundaries along the dimension of interest, typically from `UnknownMatrix::chunk_ticks()`.
+ * This should start at zero, be strictly increasing and end at the extent of the dimension.
+ * @param threads Number of threads.
+ * @param costs Pointer to an array of length equal to the number of chunks, i.e., `ticks.size() - 1`.
+ * Each entry should contain a non-negative estimate of the cost of processing the corresponding chunk, e.g., the number of structural non-zeros or the observed time to fetch the chunk.
+ * If NULL, the cost of each chunk is assumed to be proportional to its length.
+ *
+ * @return Vector of range boundaries.
+ * The `i`-th range starts at the `i`-th entry and ends before the `i + 1`-th entry.
+ * The number of ranges is no greater than `threads`, and all boundaries are present in `ticks`.
+ * Empty ranges are never reported.
+ */
+template<typename Index_, typename Cost_ = double>
+std::vector<Index_> partition_chunks(const std::vector<Index_>& ticks, const int threads, const Cost_* const costs = NULL) {
+    std::vector<Index_> boundaries;
+    if (ticks.size() < 2) {
+        return boundaries;
+    }
+
+    const auto nchunks = ticks.size() - 1;
+    boundaries.push_back(ticks.front());
+    if (threads <= 1) {
+        boundaries.push_back(ticks.back());
+        return boundaries;
+    }
+
+    // Falling back to the chunk lengths if no costs are supplied, or if all costs are zero.
+    bool use_lengths = (costs == NULL);
+    double total = 0;
+    if (!use_lengths) {
+        for (std::size_t c = 0; c < nchunks; ++c) {
+            total += costs[c];
+        }
+        use_lengths = !(total > 0);
+    }
+    if (use_lengths) {
+        total = static_cast<double>(ticks.back() - ticks.front());
+    }
+
+    auto get_cost = [&](const std::size_t c) -> double {
+        if (use_lengths) {
+            return ticks[c + 1] - ticks[c];
+        } else {
+            return costs[c];
+        }
+    };
+
+    double consumed = 0;
+    int part = 1;
+    for (std::size_t c = 0; c < nchunks; ++c) {
+        const double current = get_cost(c);
+
+        // Cutting before this chunk if that puts the boundary closer to the ideal split.
+        if (part < threads) {
+            const double target = total * part / threads;
+            const double after = consumed + current;
+            if (after > target && boundaries.back() != ticks[c] && target - consumed < after - target) {
+                boundaries.push_back(ticks[c]);
+                ++part;
+            }
+        }
+
+        // Otherwise cutting after this chunk, possibly skipping multiple splits if this chunk is very expensive.
+        consumed += current;
+        while (part < threads && consumed >= total * part / threads) {
+            if (boundaries.back() != ticks[c + 1]) {
+                boundaries.push_back(ticks[c + 1]);
+            }
+            ++part;
+        }
+    }
+
+    if (boundaries.back() != ticks.back()) {
+        boundaries.push_back(ticks.back());
+    }
+    return boundaries;
+}
+
+}
+
+#endif
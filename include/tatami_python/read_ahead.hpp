@@ -0,0 +1,140 @@
+#ifndef TATAMI_PYTHON_READ_AHEAD_HPP
+#define TATAMI_PYTHON_READ_AHEAD_HPP
+
+#include "tatami/tatami.hpp"
+#include "tatami_chunked/tatami_chunked.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace tatami_python {
+
+// Detects whether a myopic core is being used to iterate along the target dimension with a constant stride, e.g., consecutive rows.
+// Once enough consecutive requests have the same (non-zero) stride, the core can switch to an oracular cache that predicts the rest of the sequence,
+// allowing upcoming chunks to be batched into a single Python call.
+template<typename Index_>
+class StrideDetector {
+private:
+    static constexpr std::size_t min_run = 4;
+
+    bool my_started = false;
+    Index_ my_last = 0;
+    Index_ my_step = 0;
+    bool my_forward = true;
+    std::size_t my_run = 0;
+
+public:
+    // Returns true if 'i' continues a sufficiently long run of requests with a constant stride.
+    bool record(const Index_ i) {
+        if (!my_started) {
+            my_started = true;
+            my_last = i;
+            return false;
+        }
+
+        const bool forward = (i > my_last);
+        const Index_ step = (forward ? i - my_last : my_last - i);
+        my_last = i;
+        if (step == 0) {
+            my_run = 0;
+            return false;
+        }
+
+        if (my_run && step == my_step && forward == my_forward) {
+            ++my_run;
+        } else {
+            my_step = step;
+            my_forward = forward;
+            my_run = 1;
+        }
+        return my_run >= min_run;
+    }
+
+    // Forget the current run, e.g., after the predicted sequence has been broken.
+    void reset() {
+        my_started = false;
+        my_run = 0;
+    }
+
+    Index_ step() const {
+        return my_step;
+    }
+
+    bool forward() const {
+        return my_forward;
+    }
+};
+
+// Number of slabs to take from the cache of a myopic core for its read-ahead cache.
+// Reading ahead is only worthwhile if both caches can hold at least two slabs, so the myopic core keeps the entire cache (and never reads ahead) if it is too small.
+template<typename Index_>
+std::size_t read_ahead_slabs(const bool read_ahead, const tatami_chunked::SlabCacheStats<Index_>& stats) {
+    if (!read_ahead || stats.max_slabs_in_cache < 4) {
+        return 0;
+    }
+    return stats.max_slabs_in_cache / 2;
+}
+
+template<typename Index_>
+tatami_chunked::SlabCacheStats<Index_> remove_read_ahead_slabs(tatami_chunked::SlabCacheStats<Index_> stats, const std::size_t num_slabs) {
+    stats.max_slabs_in_cache -= num_slabs;
+    return stats;
+}
+
+// Furthest row/column from the start of the 'chunk'-th chunk (or the end, if '!forward') that lies within 'num_slabs' chunks.
+// Predictions are limited to this index so that the read-ahead cache is filled at most once per oracle,
+// i.e., we never fetch chunks beyond the capacity of the cache that would be wasted if the sequence were broken.
+template<typename Index_>
+Index_ read_ahead_limit(const std::vector<Index_>& ticks, const Index_ chunk, const bool forward, const std::size_t num_slabs) {
+    const Index_ num_chunks = ticks.size() - 1;
+    if (forward) {
+        const Index_ remaining = num_chunks - chunk;
+        const Index_ last = (num_slabs < static_cast<std::size_t>(remaining) ? chunk + static_cast<Index_>(num_slabs) : num_chunks);
+        return ticks[last] - 1;
+    } else {
+        const Index_ remaining = chunk + 1;
+        const Index_ first = (num_slabs < static_cast<std::size_t>(remaining) ? remaining - static_cast<Index_>(num_slabs) : 0);
+        return ticks[first];
+    }
+}
+
+// Predicts a sequence of indices with a constant stride, starting at 'start' and continuing up to 'limit' (inclusive), which should be no less (or greater, if '!forward') than 'start'.
+template<typename Index_>
+class StrideOracle final : public tatami::Oracle<Index_> {
+public:
+    StrideOracle(const Index_ start, const Index_ step, const bool forward, const Index_ limit) : my_start(start), my_step(step), my_forward(forward) {
+        // Computing the number of predictions without overflow, given that 'start' and 'limit' are both in [0, extent).
+        const Index_ available = (forward ? limit - start : start - limit);
+        my_total = static_cast<tatami::PredictionIndex>(available / step) + 1;
+    }
+
+private:
+    Index_ my_start, my_step;
+    bool my_forward;
+    tatami::PredictionIndex my_total;
+
+public:
+    tatami::PredictionIndex total() const {
+        return my_total;
+    }
+
+    Index_ get(const tatami::PredictionIndex p) const {
+        // No overflow is possible as all predictions lie within the target dimension.
+        const Index_ shift = my_step * static_cast<Index_>(p);
+        return (my_forward ? my_start + shift : my_start - shift);
+    }
+
+    // Whether 'i' would be the next index after the last prediction, i.e., the sequence continues beyond 'limit'.
+    bool continued_by(const Index_ i) const {
+        const Index_ last = get(my_total - 1);
+        if (my_forward) {
+            return i > last && i - last == my_step;
+        } else {
+            return i < last && last - i == my_step;
+        }
+    }
+};
+
+}
+
+#endif
@@ -6,12 +6,19 @@
 #include "tatami_chunked/tatami_chunked.hpp"
 
 #include "utils.hpp"
+#include "ticks.hpp"
+#include "granularity.hpp"
+#include "read_ahead.hpp"
+#include "cache_policy.hpp"
 #include "sparse_matrix.hpp"
 #include "parallelize.hpp"
 
 #include <vector>
 #include <stdexcept>
 #include <optional>
+#include <memory>
+#include <algorithm>
+#include <limits>
 
 namespace tatami_python {
 
@@ -19,6 +26,15 @@ namespace tatami_python {
 //
 // - No need to protect against overflows when creating pybind11::array_t<Index_t> from dimension extents.
 //   We already know that the dimension extent can be safely converted to/from an int, based on checks in the UnknownMatrix constructor.
+//
+// - The sparse extractors return pointers into the cached slab when the cached types are the same as the interface types, otherwise they copy into the buffers.
+//   Slab pointers are only guaranteed to be valid until the next fetch() call, which is consistent with tatami's contract for SparseRange.
+//
+// - If CoreOptions::read_ahead is true, MyopicSparseCore switches to an internal OracularSparseCore when it detects a constant stride in the requests.
+//   This is the same as the approach used in MyopicDenseCore.
+//
+// - Each core reports the bytes held by its slabs, staging buffers and pinned non-target array to CoreOptions::memory.
+//   Results from Python are also tracked for the duration of each call, using the size of the corresponding slabs as an upper bound.
 
 /********************
  *** Core classes ***
@@ -43,6 +59,54 @@ void initialize_tmp_buffers(
     }
 }
 
+// Size of each row/column of a chunk in the cache, for recording accesses.
+template<typename CachedValue_, typename CachedIndex_>
+std::size_t compute_target_bytes(const std::size_t non_target_length, const bool needs_value, const bool needs_index) {
+    return ((needs_value ? sizeof(CachedValue_) : 0) + (needs_index ? sizeof(CachedIndex_) : 0)) * non_target_length;
+}
+
+// Bytes allocated by the slab factory for 'num_slabs' slabs, each of which contains 'target_length' rows/columns.
+// This includes the per-row/column pointers into the pools, which are allocated by the factory for each slab.
+template<typename CachedValue_, typename CachedIndex_>
+std::size_t sparse_cache_bytes(const std::size_t slab_size_in_elements, const std::size_t num_slabs, const std::size_t target_length, const bool needs_value, const bool needs_index) {
+    const std::size_t pools = compute_target_bytes<CachedValue_, CachedIndex_>(slab_size_in_elements, needs_value, needs_index);
+    const std::size_t per_target = sizeof(CachedIndex_) + (needs_value ? sizeof(CachedValue_*) : 0) + (needs_index ? sizeof(CachedIndex_*) : 0);
+    return (pools + per_target * target_length) * num_slabs; // no overflow as the slabs have already been allocated.
+}
+
+template<typename CachedValue_, typename CachedIndex_>
+std::size_t tmp_buffer_bytes(const std::vector<CachedValue_>& tmp_value, const std::vector<CachedIndex_>& tmp_index) {
+    return tmp_value.capacity() * sizeof(CachedValue_) + tmp_index.capacity() * sizeof(CachedIndex_);
+}
+
+template<typename Index_, class Slab_, typename CachedValue_, typename CachedIndex_>
+void extract_sparse_element(
+    const pybind11::object& extractor,
+    const pybind11::object& matrix,
+    const CoreOptions& options,
+    pybind11::tuple& args,
+    const bool row,
+    const Index_ i,
+    Slab_& slab,
+    std::vector<CachedValue_>& value_tmp,
+    std::vector<CachedIndex_>& index_tmp,
+    const NonTargetRemapper<Index_>& remapper
+) {
+    slab.number[0] = 0;
+    args[static_cast<int>(!row)] = create_indexing_array<Index_>(i, 1);
+    const auto obj = call_extractor(extractor, matrix, options, args);
+    parse_sparse_matrix(
+        obj,
+        row,
+        slab.values,
+        value_tmp.data(),
+        slab.indices,
+        index_tmp.data(),
+        slab.number,
+        remapper
+    );
+}
+
 template<bool oracle_, typename Index_, typename CachedValue_, typename CachedIndex_>
 class SoloSparseCore {
 public:
@@ -50,18 +114,25 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         pybind11::array non_target_extract, 
+        NonTargetRemapper<Index_> remapper,
         [[maybe_unused]] Index_ max_target_chunk_length, // provided here for compatibility with the other Sparse*Core classes.
-        [[maybe_unused]] const std::vector<Index_>& ticks,
-        [[maybe_unused]] const std::vector<Index_>& map,
+        const std::vector<Index_>& ticks, // only used for recording accesses, see CoreOptions::trace.
+        const ChunkLookup<Index_>& map,
         [[maybe_unused]] const tatami_chunked::SlabCacheStats<Index_>& stats,
         const bool needs_value,
         const bool needs_index
     ) : 
         my_matrix(matrix),
         my_sparse_extractor(sparse_extractor),
+        my_options(options),
         my_row(row),
+        my_remapper(std::move(remapper)),
+        my_chunk_ticks(ticks),
+        my_chunk_map(map),
+        my_target_bytes(compute_target_bytes<CachedValue_, CachedIndex_>(non_target_extract.size(), needs_value, needs_index)),
         my_factory(
             1,
             sanisizer::cast<CachedIndex_>(non_target_extract.size()),
@@ -70,9 +141,16 @@ public:
             needs_index
         ),
         my_solo(my_factory.create()),
-        my_oracle(std::move(oracle))
+        my_oracle(std::move(oracle)),
+        my_memory(options.memory)
     {
         initialize_tmp_buffers<Index_>(row, 1, non_target_extract.size(), needs_value, my_value_tmp, needs_index, my_index_tmp);
+        my_memory.resize(
+            non_target_extract.nbytes() +
+            sparse_cache_bytes<CachedValue_, CachedIndex_>(non_target_extract.size(), 1, 1, needs_value, needs_index) +
+            tmp_buffer_bytes(my_value_tmp, my_index_tmp)
+        );
+        my_trace_tag = create_trace_tag(options);
         my_extract_args.emplace(2);
         (*my_extract_args)[static_cast<int>(row)] = std::move(non_target_extract);
     }
@@ -88,9 +166,15 @@ public:
 private:
     const pybind11::object& my_matrix;
     const pybind11::object& my_sparse_extractor;
+    const CoreOptions& my_options;
     std::optional<pybind11::tuple> my_extract_args;
 
     bool my_row;
+    NonTargetRemapper<Index_> my_remapper;
+
+    const std::vector<Index_>& my_chunk_ticks;
+    const ChunkLookup<Index_>& my_chunk_map;
+    std::size_t my_target_bytes;
 
     tatami_chunked::SparseSlabFactory<CachedValue_, CachedIndex_> my_factory;
     typedef typename decltype(my_factory)::Slab Slab;
@@ -102,28 +186,24 @@ private:
     std::vector<CachedValue_> my_value_tmp;
     std::vector<CachedIndex_> my_index_tmp;
 
+    TrackedMemory my_memory;
+    TraceTag my_trace_tag;
+
 public:
     std::pair<const Slab*, Index_> fetch_raw(Index_ i) {
         if constexpr(oracle_) {
             i = my_oracle->get(my_counter++);
         }
-        my_solo.number[0] = 0;
+        if (my_options.trace) {
+            record_access(my_options, my_trace_tag, my_row, my_chunk_ticks, my_chunk_map[i], my_target_bytes);
+        }
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
-        TATAMI_PYTHON_SERIALIZE([&]() -> void {
+        serialize(my_options.thread_safe, [&]() -> void {
 #endif
 
-        (*my_extract_args)[static_cast<int>(!my_row)] = create_indexing_array<Index_>(i, 1);
-        const auto obj = my_sparse_extractor(my_matrix, *my_extract_args);
-        parse_sparse_matrix(
-            obj,
-            my_row,
-            my_solo.values,
-            my_value_tmp.data(),
-            my_solo.indices,
-            my_index_tmp.data(),
-            my_solo.number
-        );
+        TrackedMemory in_flight(my_options.memory, my_target_bytes);
+        extract_sparse_element(my_sparse_extractor, my_matrix, my_options, *my_extract_args, my_row, i, my_solo, my_value_tmp, my_index_tmp, my_remapper);
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
         });
@@ -133,6 +213,9 @@ public:
     }
 };
 
+template<typename Index_, typename CachedValue_, typename CachedIndex_>
+class OracularSparseCore;
+
 template<typename Index_, typename CachedValue_, typename CachedIndex_>
 class MyopicSparseCore {
 public:
@@ -140,30 +223,58 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         [[maybe_unused]] tatami::MaybeOracle<false, Index_> oracle, // provided here for compatibility with the other Sparse*Core classes.
         pybind11::array non_target_extract, 
+        NonTargetRemapper<Index_> remapper,
         const Index_ max_target_chunk_length, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats,
         const bool needs_value,
         const bool needs_index
     ) : 
         my_matrix(matrix),
         my_sparse_extractor(sparse_extractor),
+        my_options(options),
         my_row(row),
+        my_remapper(std::move(remapper)),
         my_chunk_ticks(ticks),
         my_chunk_map(map),
+        my_read_ahead_slabs(read_ahead_slabs(options.read_ahead, stats)),
+        my_stats(remove_read_ahead_slabs(stats, my_read_ahead_slabs)),
+        my_max_target_chunk_length(max_target_chunk_length),
+        my_target_bytes(compute_target_bytes<CachedValue_, CachedIndex_>(non_target_extract.size(), needs_value, needs_index)),
         my_factory(
             sanisizer::cast<CachedIndex_>(max_target_chunk_length),
             sanisizer::cast<CachedIndex_>(non_target_extract.size()),
-            stats,
+            my_stats,
             needs_value,
             needs_index
         ),
-        my_cache(stats.max_slabs_in_cache)
+        my_cache(options.cache_policy, my_stats.max_slabs_in_cache),
+        my_needs_value(needs_value),
+        my_needs_index(needs_index),
+        my_memory(options.memory)
     {
+        // No point adapting the granularity if each chunk only contains one element anyway.
+        if (worth_adapting_granularity(options.adaptive_granularity, my_stats.slab_size_in_elements, non_target_extract.size())) {
+            my_granularity.emplace(my_stats.max_slabs_in_cache);
+            my_element_factory.emplace(1, sanisizer::cast<CachedIndex_>(non_target_extract.size()), 1, needs_value, needs_index);
+            my_element.emplace(my_element_factory->create());
+        }
+        // Similarly, no point reading ahead if either cache can't hold more than one chunk at a time, see read_ahead_slabs().
+        if (my_read_ahead_slabs) {
+            my_stride.emplace();
+        }
         initialize_tmp_buffers<Index_>(row, max_target_chunk_length, non_target_extract.size(), needs_value, my_value_tmp, needs_index, my_index_tmp);
+        my_memory.resize(
+            non_target_extract.nbytes() +
+            sparse_cache_bytes<CachedValue_, CachedIndex_>(my_stats.slab_size_in_elements, my_stats.max_slabs_in_cache, max_target_chunk_length, needs_value, needs_index) +
+            (my_element.has_value() ? sparse_cache_bytes<CachedValue_, CachedIndex_>(non_target_extract.size(), 1, 1, needs_value, needs_index) : 0) +
+            tmp_buffer_bytes(my_value_tmp, my_index_tmp)
+        );
+        my_trace_tag = create_trace_tag(options);
         my_extract_args.emplace(2);
         (*my_extract_args)[static_cast<int>(row)] = std::move(non_target_extract);
     }
@@ -179,40 +290,178 @@ public:
 private:
     const pybind11::object& my_matrix;
     const pybind11::object& my_sparse_extractor;
+    const CoreOptions& my_options;
     std::optional<pybind11::tuple> my_extract_args;
 
     bool my_row;
+    NonTargetRemapper<Index_> my_remapper;
 
     const std::vector<Index_>& my_chunk_ticks;
-    const std::vector<Index_>& my_chunk_map;
+    const ChunkLookup<Index_>& my_chunk_map;
+    std::size_t my_read_ahead_slabs; // taken from the cache in 'stats', so my_stats only refers to the myopic cache.
+    tatami_chunked::SlabCacheStats<Index_> my_stats;
+    Index_ my_max_target_chunk_length;
+    std::size_t my_target_bytes;
 
     tatami_chunked::SparseSlabFactory<CachedValue_, CachedIndex_> my_factory;
     typedef typename decltype(my_factory)::Slab Slab;
-    tatami_chunked::LruSlabCache<Index_, Slab> my_cache;
+    PolicySlabCache<Index_, Slab> my_cache;
+
+    bool my_needs_value;
+    bool my_needs_index;
+    TrackedMemory my_memory;
+    TraceTag my_trace_tag;
 
     std::vector<CachedValue_> my_value_tmp;
     std::vector<CachedIndex_> my_index_tmp;
 
+    std::optional<GranularityPolicy<Index_> > my_granularity;
+    std::optional<tatami_chunked::SparseSlabFactory<CachedValue_, CachedIndex_> > my_element_factory;
+    std::optional<Slab> my_element;
+
+    std::optional<StrideDetector<Index_> > my_stride;
+    std::optional<Index_> my_last_chunk;
+    std::size_t my_num_read_ahead = 0;
+    std::size_t my_shared_bytes = 0;
+    std::shared_ptr<const StrideOracle<Index_> > my_read_ahead_oracle;
+    tatami::PredictionIndex my_read_ahead_counter = 0;
+    std::optional<OracularSparseCore<Index_, CachedValue_, CachedIndex_> > my_read_ahead;
+
+    void start_read_ahead(const Index_ i) {
+        // The read-ahead core is oracle-aware, so its batches are subject to the same minimum size as those of the oracle-aware extractors.
+        auto read_ahead_stats = my_stats;
+        read_ahead_stats.max_slabs_in_cache = my_read_ahead_slabs;
+        enforce_minimum_batch(read_ahead_stats, static_cast<Index_>(my_chunk_ticks.size() - 1), my_options.minimum_batch_elements);
+
+        const auto limit = read_ahead_limit(my_chunk_ticks, my_chunk_map[i], my_stride->forward(), read_ahead_stats.max_slabs_in_cache);
+        my_read_ahead_oracle = std::make_shared<const StrideOracle<Index_> >(i, my_stride->step(), my_stride->forward(), limit);
+        my_read_ahead_counter = 1;
+
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+        serialize(my_options.thread_safe, [&]() -> void {
+#endif
+
+        auto non_target_extract = (*my_extract_args)[static_cast<int>(my_row)].template cast<pybind11::array>();
+        my_read_ahead.emplace(
+            my_matrix,
+            my_sparse_extractor,
+            my_row,
+            my_options,
+            my_read_ahead_oracle,
+            non_target_extract,
+            my_remapper,
+            my_max_target_chunk_length,
+            my_chunk_ticks,
+            my_chunk_map,
+            read_ahead_stats,
+            my_needs_value,
+            my_needs_index,
+            TraceTag{ my_trace_tag.extractor, ++my_num_read_ahead }
+        );
+
+        // The read-ahead core counts the non-target array towards the memory usage, so we stop counting it here to avoid double-counting.
+        my_shared_bytes = non_target_extract.nbytes();
+        my_memory.resize(my_memory.bytes() - my_shared_bytes);
+
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+        });
+#endif
+    }
+
+    void stop_read_ahead() {
+        my_read_ahead.reset();
+        my_memory.resize(my_memory.bytes() + my_shared_bytes);
+        my_shared_bytes = 0;
+        my_read_ahead_oracle.reset();
+    }
+
+    bool use_read_ahead(const Index_ i) {
+        if (!my_stride.has_value()) {
+            return false;
+        }
+
+        if (my_read_ahead.has_value()) {
+            if (my_read_ahead_counter < my_read_ahead_oracle->total() && my_read_ahead_oracle->get(my_read_ahead_counter) == i) {
+                ++my_read_ahead_counter;
+                return true;
+            }
+
+            // Predictions only extend as far as the read-ahead cache can hold, so we start a new oracle if the request continues the sequence.
+            // This lies in a chunk beyond the previous predictions, so the chunks in the previous read-ahead cache will not be needed again.
+            const bool continued = (my_read_ahead_counter == my_read_ahead_oracle->total() && my_read_ahead_oracle->continued_by(i));
+            stop_read_ahead();
+            if (continued) {
+                start_read_ahead(i);
+                return true;
+            }
+
+            // Otherwise, the request deviates from the predicted sequence, so we go back to myopic extraction and start looking for a new stride.
+            my_stride->reset();
+        }
+
+        if (!my_stride->record(i)) {
+            return false;
+        }
+
+        // If the request lies in the chunk that was last loaded into the myopic cache, we continue to serve it from the myopic cache.
+        // This avoids refetching the same chunk into the read-ahead cache; the switch will occur when the sequence moves onto the next chunk.
+        if (my_last_chunk.has_value() && *my_last_chunk == my_chunk_map[i]) {
+            return false;
+        }
+
+        start_read_ahead(i);
+        increment_counter(my_options.counters.switches_to_read_ahead);
+        return true;
+    }
+
 public:
     std::pair<const Slab*, Index_> fetch_raw(Index_ i) {
+        if (use_read_ahead(i)) {
+            return my_read_ahead->fetch_raw(i);
+        }
+
         const auto chosen = my_chunk_map[i];
+        record_access(my_options, my_trace_tag, my_row, my_chunk_ticks, chosen, my_target_bytes);
 
+        if (my_granularity.has_value() && !my_granularity->use_chunks()) {
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+            serialize(my_options.thread_safe, [&]() -> void {
+#endif
+
+            TrackedMemory in_flight(my_options.memory, my_target_bytes);
+            extract_sparse_element(my_sparse_extractor, my_matrix, my_options, *my_extract_args, my_row, i, *my_element, my_value_tmp, my_index_tmp, my_remapper);
+
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
+            });
+#endif
+
+            increment_counter(my_options.counters.element_loads);
+            my_last_chunk.reset();
+            if (my_granularity->record_element_request(chosen)) {
+                increment_counter(my_options.counters.switches_to_chunk);
+            }
+            return std::make_pair(&(*my_element), static_cast<Index_>(0));
+        }
+
+        bool loaded = false;
         const auto& slab = my_cache.find(
             chosen,
             [&]() -> Slab {
                 return my_factory.create();
             },
             [&](const Index_ id, Slab& cache) -> void {
+                loaded = true;
                 const auto chunk_start = my_chunk_ticks[id], chunk_end = my_chunk_ticks[id + 1];
                 const Index_ chunk_len = chunk_end - chunk_start;
                 std::fill_n(cache.number, chunk_len, 0);
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
-                TATAMI_PYTHON_SERIALIZE([&]() -> void {
+                serialize(my_options.thread_safe, [&]() -> void {
 #endif
 
                 (*my_extract_args)[static_cast<int>(!my_row)] = create_indexing_array<Index_>(chunk_start, chunk_len);
-                const auto obj = my_sparse_extractor(my_matrix, *my_extract_args);
+                TrackedMemory in_flight(my_options.memory, my_target_bytes * static_cast<std::size_t>(chunk_len));
+                const auto obj = call_extractor(my_sparse_extractor, my_matrix, my_options, *my_extract_args);
                 parse_sparse_matrix(
                     obj,
                     my_row,
@@ -220,7 +469,8 @@ public:
                     my_value_tmp.data(),
                     cache.indices,
                     my_index_tmp.data(),
-                    cache.number
+                    cache.number,
+                    my_remapper
                 );
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
@@ -229,6 +479,14 @@ public:
             }
         );
 
+        if (loaded) {
+            increment_counter(my_options.counters.chunk_loads);
+        }
+        my_last_chunk = chosen;
+        if (my_granularity.has_value() && my_granularity->record_chunk_request(loaded)) {
+            increment_counter(my_options.counters.switches_to_element);
+        }
+
         const Index_ offset = i - my_chunk_ticks[chosen];
         return std::make_pair(&slab, offset);
     }
@@ -241,18 +499,23 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<true, Index_> oracle,
         pybind11::array non_target_extract, 
+        NonTargetRemapper<Index_> remapper,
         const Index_ max_target_chunk_length, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats,
         const bool needs_value,
-        const bool needs_index
+        const bool needs_index,
+        const std::optional<TraceTag>& parent_tag = std::nullopt // only set for the read-ahead core of a myopic extractor, see CoreOptions::trace.
     ) : 
         my_matrix(matrix),
         my_sparse_extractor(sparse_extractor),
+        my_options(options),
         my_row(row),
+        my_remapper(std::move(remapper)),
         my_chunk_ticks(ticks),
         my_chunk_map(map),
         my_factory(
@@ -264,11 +527,28 @@ public:
         ),
         my_cache(std::move(oracle), stats.max_slabs_in_cache),
         my_needs_value(needs_value),
-        my_needs_index(needs_index)
+        my_needs_index(needs_index),
+        my_target_bytes(compute_target_bytes<CachedValue_, CachedIndex_>(non_target_extract.size(), needs_value, needs_index)),
+        my_memory(options.memory)
     {
-        // map.size() is equal to the extent of the target dimension.
-        // We don't know how many chunks we might bundle together in a single call, so better overestimate to be safe.
-        initialize_tmp_buffers<Index_>(row, map.size(), non_target_extract.size(), needs_value, my_value_tmp, needs_index, my_index_tmp);
+        // For row extraction, the staging buffers must be able to hold all rows in a single call.
+        // A batch never contains more chunks than the cache, so we only need enough space for the largest batch;
+        // this is further capped by CoreOptions::maximum_staging_elements and CoreOptions::maximum_batch_elements, in which case larger batches are split into multiple calls.
+        // Note that we need at least one chunk's worth of space, and that ticks.back() is equal to the extent of the target dimension.
+        const std::size_t call_limited = max_batch_length(options, non_target_extract.size());
+        std::size_t staging_length = max_target_chunk_length;
+        if (max_target_chunk_length > 0 && stats.max_slabs_in_cache > 1) {
+            const std::size_t slab_limited = (static_cast<std::size_t>(ticks.back()) / max_target_chunk_length < stats.max_slabs_in_cache ? ticks.back() : stats.max_slabs_in_cache * max_target_chunk_length);
+            const std::size_t staging_limited = (options.maximum_staging_elements ? options.maximum_staging_elements : slab_limited);
+            staging_length = std::max(static_cast<std::size_t>(max_target_chunk_length), std::min({ slab_limited, staging_limited, call_limited }));
+        }
+        initialize_tmp_buffers<Index_>(row, static_cast<Index_>(staging_length), non_target_extract.size(), needs_value, my_value_tmp, needs_index, my_index_tmp); // cast is safe as it is no greater than the extent.
+        my_max_batch_length = (row ? std::min(call_limited, staging_length) : call_limited);
+        my_fixed_bytes = non_target_extract.nbytes() +
+            sparse_cache_bytes<CachedValue_, CachedIndex_>(stats.slab_size_in_elements, stats.max_slabs_in_cache, max_target_chunk_length, needs_value, needs_index) +
+            tmp_buffer_bytes(my_value_tmp, my_index_tmp);
+        my_memory.resize(my_fixed_bytes);
+        my_trace_tag = (parent_tag.has_value() ? *parent_tag : create_trace_tag(options));
         my_extract_args.emplace(2);
         (*my_extract_args)[static_cast<int>(row)] = std::move(non_target_extract);
     }
@@ -284,12 +564,14 @@ public:
 private:
     const pybind11::object& my_matrix;
     const pybind11::object& my_sparse_extractor;
+    const CoreOptions& my_options;
     std::optional<pybind11::tuple> my_extract_args;
 
     bool my_row;
+    NonTargetRemapper<Index_> my_remapper;
 
     const std::vector<Index_>& my_chunk_ticks;
-    const std::vector<Index_>& my_chunk_map;
+    const ChunkLookup<Index_>& my_chunk_map;
 
     tatami_chunked::SparseSlabFactory<CachedValue_, CachedIndex_> my_factory;
     typedef typename decltype(my_factory)::Slab Slab;
@@ -301,6 +583,15 @@ private:
 
     bool my_needs_value;
     bool my_needs_index;
+    std::size_t my_target_bytes;
+
+    // The pointer and number vectors grow with the largest batch, so the tracked memory is updated after each batch.
+    TrackedMemory my_memory;
+    TraceTag my_trace_tag;
+    std::size_t my_fixed_bytes = 0;
+
+    // Maximum number of rows/columns along the target dimension in each call, see the constructor.
+    std::size_t my_max_batch_length = 0;
 
     std::vector<CachedValue_> my_value_tmp;
     std::vector<CachedIndex_> my_index_tmp;
@@ -310,6 +601,7 @@ public:
         return my_cache.next(
             [&](const Index_ i) -> std::pair<Index_, Index_> {
                 auto chosen = my_chunk_map[i];
+                record_access(my_options, my_trace_tag, my_row, my_chunk_ticks, chosen, my_target_bytes);
                 return std::make_pair(chosen, static_cast<Index_>(i - my_chunk_ticks[chosen]));
             },
             [&]() -> Slab {
@@ -323,68 +615,127 @@ public:
                 if (!std::is_sorted(to_populate.begin(), to_populate.end(), cmp)) {
                     std::sort(to_populate.begin(), to_populate.end(), cmp);
                 }
-
-                if (my_needs_value) {
-                    my_chunk_value_ptrs.clear();
-                }
-                if (my_needs_index) {
-                    my_chunk_index_ptrs.clear();
-                }
-
-                Index_ total_len = 0;
-                for (const auto& p : to_populate) {
-                    Index_ chunk_len = my_chunk_ticks[p.first + 1] - my_chunk_ticks[p.first];
-                    total_len += chunk_len;
-                    if (my_needs_value) {
-                        auto vIt = p.second->values.begin();
-                        my_chunk_value_ptrs.insert(my_chunk_value_ptrs.end(), vIt, vIt + chunk_len);
-                    }
-                    if (my_needs_index) {
-                        auto iIt = p.second->indices.begin();
-                        my_chunk_index_ptrs.insert(my_chunk_index_ptrs.end(), iIt, iIt + chunk_len);
-                    }
-                }
-
-                my_chunk_numbers.clear();
-                tatami::resize_container_to_Index_size(my_chunk_numbers, total_len);
+                increment_counter(my_options.counters.chunk_loads, to_populate.size());
 
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
-                TATAMI_PYTHON_SERIALIZE([&]() -> void {
+                serialize(my_options.thread_safe, [&]() -> void {
 #endif
 
-                pybind11::array_t<Index_> primary_extract(total_len); // known to be safe, from the constructor.
-                auto pptr = static_cast<Index_*>(primary_extract.request().ptr);
-                Index_ current = 0;
-                for (const auto& p : to_populate) {
-                    const Index_ chunk_start = my_chunk_ticks[p.first];
-                    const Index_ chunk_len = my_chunk_ticks[p.first + 1] - chunk_start;
-                    auto start = pptr + current;
-                    std::iota(start, start + chunk_len, chunk_start);
-                    current += chunk_len;
-                }
-
-                (*my_extract_args)[static_cast<int>(!my_row)] = std::move(primary_extract);
-                auto obj = my_sparse_extractor(my_matrix, *my_extract_args);
-                parse_sparse_matrix(
-                    obj,
-                    my_row,
-                    my_chunk_value_ptrs,
-                    my_value_tmp.data(),
-                    my_chunk_index_ptrs,
-                    my_index_tmp.data(),
-                    my_chunk_numbers.data()
+                const bool use_chunks = my_options.sparse_chunk_extractor.has_value();
+                extract_in_flight_within_limit(
+                    (use_chunks ? *(my_options.sparse_chunk_extractor) : my_sparse_extractor),
+                    my_options,
+                    to_populate.size(),
+                    [&](const std::size_t x) -> std::size_t {
+                        const auto id = to_populate[x].first;
+                        return my_chunk_ticks[id + 1] - my_chunk_ticks[id];
+                    },
+                    my_target_bytes,
+                    my_max_batch_length,
+                    [&](const std::size_t first, const std::size_t last) -> pybind11::tuple {
+                        if (use_chunks) {
+                            return create_chunk_args(my_matrix, to_populate, first, last, my_chunk_ticks, *my_extract_args, my_row);
+                        }
+
+                        Index_ total_len = 0;
+                        for (auto x = first; x < last; ++x) {
+                            const auto& p = to_populate[x];
+                            total_len += my_chunk_ticks[p.first + 1] - my_chunk_ticks[p.first];
+                        }
+
+                        pybind11::array_t<Index_> primary_extract(total_len); // known to be safe, from the constructor.
+                        auto pptr = static_cast<Index_*>(primary_extract.request().ptr);
+                        Index_ current = 0;
+                        for (auto x = first; x < last; ++x) {
+                            const auto& p = to_populate[x];
+                            const Index_ chunk_start = my_chunk_ticks[p.first];
+                            const Index_ chunk_len = my_chunk_ticks[p.first + 1] - chunk_start;
+                            auto start = pptr + current;
+                            std::iota(start, start + chunk_len, chunk_start);
+                            current += chunk_len;
+                        }
+
+                        return pybind11::make_tuple(my_matrix, create_extract_args(*my_extract_args, my_row, std::move(primary_extract)));
+                    },
+                    [&](const std::size_t first, const std::size_t last, const pybind11::object& obj) -> void {
+                        if (use_chunks) {
+                            auto parts = split_chunk_results(obj, last - first);
+                            if (parts.has_value()) {
+                                for (auto x = first; x < last; ++x) {
+                                    const auto& p = to_populate[x];
+                                    const Index_ chunk_len = my_chunk_ticks[p.first + 1] - my_chunk_ticks[p.first];
+                                    std::fill_n(p.second->number, chunk_len, 0);
+                                    parse_sparse_matrix(
+                                        pybind11::object((*parts)[x - first]),
+                                        my_row,
+                                        p.second->values,
+                                        my_value_tmp.data(),
+                                        p.second->indices,
+                                        my_index_tmp.data(),
+                                        p.second->number,
+                                        my_remapper
+                                    );
+                                }
+                                return;
+                            }
+                        }
+
+                        if (my_needs_value) {
+                            my_chunk_value_ptrs.clear();
+                        }
+                        if (my_needs_index) {
+                            my_chunk_index_ptrs.clear();
+                        }
+
+                        Index_ total_len = 0;
+                        for (auto x = first; x < last; ++x) {
+                            const auto& p = to_populate[x];
+                            Index_ chunk_len = my_chunk_ticks[p.first + 1] - my_chunk_ticks[p.first];
+                            total_len += chunk_len;
+                            if (my_needs_value) {
+                                auto vIt = p.second->values.begin();
+                                my_chunk_value_ptrs.insert(my_chunk_value_ptrs.end(), vIt, vIt + chunk_len);
+                            }
+                            if (my_needs_index) {
+                                auto iIt = p.second->indices.begin();
+                                my_chunk_index_ptrs.insert(my_chunk_index_ptrs.end(), iIt, iIt + chunk_len);
+                            }
+                        }
+
+                        my_chunk_numbers.clear();
+                        tatami::resize_container_to_Index_size(my_chunk_numbers, total_len);
+
+                        parse_sparse_matrix(
+                            obj,
+                            my_row,
+                            my_chunk_value_ptrs,
+                            my_value_tmp.data(),
+                            my_chunk_index_ptrs,
+                            my_index_tmp.data(),
+                            my_chunk_numbers.data(),
+                            my_remapper
+                        );
+
+                        Index_ current = 0;
+                        for (auto x = first; x < last; ++x) {
+                            const auto& p = to_populate[x];
+                            Index_ chunk_len = my_chunk_ticks[p.first + 1] - my_chunk_ticks[p.first];
+                            std::copy_n(my_chunk_numbers.begin() + current, chunk_len, p.second->number);
+                            current += chunk_len;
+                        }
+                    }
                 );
 
-                current = 0;
-                for (const auto& p : to_populate) {
-                    Index_ chunk_len = my_chunk_ticks[p.first + 1] - my_chunk_ticks[p.first];
-                    std::copy_n(my_chunk_numbers.begin() + current, chunk_len, p.second->number);
-                    current += chunk_len;
-                }
-
 #ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN 
                 });
 #endif
+
+                my_memory.resize(
+                    my_fixed_bytes +
+                    my_chunk_value_ptrs.capacity() * sizeof(CachedValue_*) +
+                    my_chunk_index_ptrs.capacity() * sizeof(CachedIndex_*) +
+                    my_chunk_numbers.capacity() * sizeof(CachedIndex_)
+                );
             }
         );
     }
@@ -410,11 +761,12 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         const Index_ non_target_dim,
         const Index_ max_target_chunk_length, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats,
         const bool needs_value,
         const bool needs_index
@@ -423,8 +775,10 @@ public:
             matrix,
             sparse_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array<Index_>(0, non_target_dim),
+            NonTargetRemapper<Index_>(),
             max_target_chunk_length,
             ticks,
             map,
@@ -432,14 +786,12 @@ public:
             needs_value,
             needs_index
         ),
-        my_non_target_dim(non_target_dim),
         my_needs_value(needs_value),
         my_needs_index(needs_index)
     {}
 
 private:
     SparseCore<solo_, oracle_, Index_, CachedValue_, CachedIndex_> my_core;
-    Index_ my_non_target_dim;
     bool my_needs_value, my_needs_index;
 
 public:
@@ -450,19 +802,29 @@ public:
 
         tatami::SparseRange<Value_, Index_> output(slab.number[offset]);
         if (my_needs_value) {
-            std::copy_n(slab.values[offset], my_non_target_dim, value_buffer);
-            output.value = value_buffer;
+            output.value = fetch_from_cache(slab.values[offset], output.number, value_buffer);
         }
 
         if (my_needs_index) {
-            std::copy_n(slab.indices[offset], my_non_target_dim, index_buffer);
-            output.index = index_buffer;
+            output.index = fetch_from_cache(slab.indices[offset], output.number, index_buffer);
         }
 
         return output;
     }
 };
 
+// Whether the original non-target indices of a block/subset fit in CachedIndex_, in which case they are remapped when populating the slab.
+// Otherwise, the slab holds indices relative to the block/subset, and these are remapped at fetch time instead.
+template<typename CachedIndex_, typename Index_>
+bool fits_in_slab(const Index_ block_start, const Index_ block_length) {
+    return block_length == 0 || !sanisizer::is_less_than(std::numeric_limits<CachedIndex_>::max(), block_start + block_length - 1);
+}
+
+template<typename CachedIndex_, typename Index_>
+bool fits_in_slab(const std::vector<Index_>& indices) {
+    return indices.empty() || !sanisizer::is_less_than(std::numeric_limits<CachedIndex_>::max(), indices.back());
+}
+
 template<bool solo_, bool oracle_, typename Value_, typename Index_, typename CachedValue_, typename CachedIndex_>
 class SparseBlock : public tatami::SparseExtractor<oracle_, Value_, Index_> {
 public:
@@ -470,12 +832,13 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         const Index_ block_start,
         const Index_ block_length,
         const Index_ max_target_chunk_length, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats,
         const bool needs_value,
         const bool needs_index
@@ -484,8 +847,10 @@ public:
             matrix,
             sparse_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array<Index_>(block_start, block_length),
+            (fits_in_slab<CachedIndex_>(block_start, block_length) ? NonTargetRemapper<Index_>(block_start) : NonTargetRemapper<Index_>()),
             max_target_chunk_length,
             ticks,
             map,
@@ -493,15 +858,18 @@ public:
             needs_value,
             needs_index
         ),
-        my_block_start(block_start),
         my_needs_value(needs_value),
         my_needs_index(needs_index)
-    {}
+    {
+        if (!fits_in_slab<CachedIndex_>(block_start, block_length)) {
+            my_fetch_remapper.emplace(block_start);
+        }
+    }
 
 private:
     SparseCore<solo_, oracle_, Index_, CachedValue_, CachedIndex_> my_core;
-    Index_ my_block_start; 
     bool my_needs_value, my_needs_index;
+    std::optional<NonTargetRemapper<Index_> > my_fetch_remapper;
 
 public:
     tatami::SparseRange<Value_, Index_> fetch(const Index_ i, Value_* const value_buffer, Index_* const index_buffer) {
@@ -511,16 +879,16 @@ public:
 
         tatami::SparseRange<Value_, Index_> output(slab.number[offset]);
         if (my_needs_value) {
-            std::copy_n(slab.values[offset], output.number, value_buffer); 
-            output.value = value_buffer;
+            output.value = fetch_from_cache(slab.values[offset], output.number, value_buffer);
         }
 
         if (my_needs_index) {
-            const auto iptr = slab.indices[offset];
-            for (Index_ i = 0; i < output.number; ++i) {
-                index_buffer[i] = static_cast<Index_>(iptr[i]) + my_block_start;
+            if (my_fetch_remapper.has_value()) {
+                my_fetch_remapper->remap(slab.indices[offset], output.number, index_buffer);
+                output.index = index_buffer;
+            } else {
+                output.index = fetch_from_cache(slab.indices[offset], output.number, index_buffer);
             }
-            output.index = index_buffer;
         }
 
         return output;
@@ -534,11 +902,12 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         tatami::VectorPtr<Index_> indices_ptr,
         const Index_ max_target_chunk_length, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats,
         const bool needs_value,
         const bool needs_index
@@ -547,8 +916,10 @@ public:
             matrix,
             sparse_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array(*indices_ptr),
+            (fits_in_slab<CachedIndex_>(*indices_ptr) ? NonTargetRemapper<Index_>(indices_ptr) : NonTargetRemapper<Index_>()),
             max_target_chunk_length,
             ticks,
             map,
@@ -556,15 +927,18 @@ public:
             needs_value,
             needs_index
         ),
-        my_indices_ptr(std::move(indices_ptr)),
         my_needs_value(needs_value),
         my_needs_index(needs_index)
-    {}
+    {
+        if (!fits_in_slab<CachedIndex_>(*indices_ptr)) {
+            my_fetch_remapper.emplace(std::move(indices_ptr));
+        }
+    }
 
 private:
     SparseCore<solo_, oracle_, Index_, CachedValue_, CachedIndex_> my_core;
-    tatami::VectorPtr<Index_> my_indices_ptr;
     bool my_needs_value, my_needs_index;
+    std::optional<NonTargetRemapper<Index_> > my_fetch_remapper;
 
 public:
     tatami::SparseRange<Value_, Index_> fetch(const Index_ i, Value_* const value_buffer, Index_* const index_buffer) {
@@ -574,17 +948,16 @@ public:
 
         tatami::SparseRange<Value_, Index_> output(slab.number[offset]);
         if (my_needs_value) {
-            std::copy_n(slab.values[offset], output.number, value_buffer); 
-            output.value = value_buffer;
+            output.value = fetch_from_cache(slab.values[offset], output.number, value_buffer);
         }
 
         if (my_needs_index) {
-            const auto iptr = slab.indices[offset];
-            const auto& indices = *my_indices_ptr;
-            for (Index_ i = 0; i < output.number; ++i) {
-                index_buffer[i] = indices[iptr[i]];
+            if (my_fetch_remapper.has_value()) {
+                my_fetch_remapper->remap(slab.indices[offset], output.number, index_buffer);
+                output.index = index_buffer;
+            } else {
+                output.index = fetch_from_cache(slab.indices[offset], output.number, index_buffer);
             }
-            output.index = index_buffer;
         }
 
         return output;
@@ -595,17 +968,54 @@ public:
  *** Densified sparse extractors ***
  ***********************************/
 
-template<typename Slab_, typename Value_, typename Index_>
-const Value_* densify(const Slab_& slab, const Index_ offset, const Index_ non_target_length, Value_* const buffer) {
-    const auto vptr = slab.values[offset];
-    const auto iptr = slab.indices[offset];
-    std::fill_n(buffer, non_target_length, 0);
-    const auto num = slab.number[offset];
-    for (Index_ i = 0; i < num; ++i) {
-        buffer[iptr[i]] = vptr[i];
+template<typename Value_, typename Index_>
+class Densifier {
+public:
+    Densifier(const Index_ non_target_length) : my_non_target_length(non_target_length) {
+        sanisizer::resize(my_buffer, non_target_length);
     }
-    return buffer;
-}
+
+private:
+    Index_ my_non_target_length;
+
+    // We densify into our own buffer rather than the user-supplied buffer.
+    // This ensures that the non-zero elements from the previous call are the only ones that need to be reset,
+    // as the user is not allowed to modify the contents of the returned pointer.
+    std::vector<Value_> my_buffer;
+    std::vector<Index_> my_last_indices;
+    bool my_last_full = false;
+
+public:
+    template<typename Slab_>
+    const Value_* densify(const Slab_& slab, const Index_ offset) {
+        if (my_last_full) {
+            std::fill(my_buffer.begin(), my_buffer.end(), 0);
+        } else {
+            for (const auto ix : my_last_indices) {
+                my_buffer[ix] = 0;
+            }
+        }
+
+        const auto vptr = slab.values[offset];
+        const auto iptr = slab.indices[offset];
+        const Index_ num = slab.number[offset];
+        const auto bptr = my_buffer.data();
+        for (Index_ i = 0; i < num; ++i) {
+            bptr[iptr[i]] = vptr[i];
+        }
+
+        // Beyond a certain density, it's faster to just reset the entire buffer in the next call,
+        // as a contiguous fill is much cheaper than a scattered reset.
+        my_last_full = num > my_non_target_length / 8;
+        if (my_last_full) {
+            my_last_indices.clear();
+        } else {
+            my_last_indices.assign(iptr, iptr + num);
+        }
+
+        return bptr;
+    }
+};
 
 template<bool solo_, bool oracle_, typename Value_, typename Index_, typename CachedValue_, typename CachedIndex_>
 class DensifiedSparseFull : public tatami::DenseExtractor<oracle_, Value_, Index_> {
@@ -614,19 +1024,22 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         const Index_ non_target_dim,
         const Index_ max_target_chunk_length, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats
     ) :
         my_core(
             matrix,
             sparse_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array<Index_>(0, non_target_dim),
+            NonTargetRemapper<Index_>(),
             max_target_chunk_length,
             ticks,
             map,
@@ -634,17 +1047,17 @@ public:
             true,
             true
         ),
-        my_non_target_dim(non_target_dim)
+        my_densifier(non_target_dim)
     {}
 
 private:
     SparseCore<solo_, oracle_, Index_, CachedValue_, CachedIndex_> my_core;
-    Index_ my_non_target_dim;
+    Densifier<Value_, Index_> my_densifier;
 
 public:
-    const Value_* fetch(const Index_ i, Value_* const buffer) {
+    const Value_* fetch(const Index_ i, Value_*) {
         const auto res = my_core.fetch_raw(i);
-        return densify(*(res.first), res.second, my_non_target_dim, buffer);
+        return my_densifier.densify(*(res.first), res.second);
     }
 };
 
@@ -655,20 +1068,23 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         const Index_ block_start,
         const Index_ block_length,
         const Index_ max_target_chunk_length, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats
     ) :
         my_core(
             matrix,
             sparse_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array<Index_>(block_start, block_length),
+            NonTargetRemapper<Index_>(),
             max_target_chunk_length,
             ticks,
             map,
@@ -676,17 +1092,17 @@ public:
             true,
             true
         ),
-        my_block_length(block_length)
+        my_densifier(block_length)
     {}
 
 private:
     SparseCore<solo_, oracle_, Index_, CachedValue_, CachedIndex_> my_core;
-    Index_ my_block_length;
+    Densifier<Value_, Index_> my_densifier;
 
 public:
-    const Value_* fetch(const Index_ i, Value_* const buffer) {
+    const Value_* fetch(const Index_ i, Value_*) {
         const auto res = my_core.fetch_raw(i);
-        return densify(*(res.first), res.second, my_block_length, buffer);
+        return my_densifier.densify(*(res.first), res.second);
     }
 };
 
@@ -697,19 +1113,22 @@ public:
         const pybind11::object& matrix, 
         const pybind11::object& sparse_extractor,
         const bool row,
+        const CoreOptions& options,
         tatami::MaybeOracle<oracle_, Index_> oracle,
         tatami::VectorPtr<Index_> idx_ptr,
         const Index_ max_target_chunk_length, 
         const std::vector<Index_>& ticks,
-        const std::vector<Index_>& map,
+        const ChunkLookup<Index_>& map,
         const tatami_chunked::SlabCacheStats<Index_>& stats
     ) :
         my_core( 
             matrix,
             sparse_extractor,
             row,
+            options,
             std::move(oracle),
             create_indexing_array(*idx_ptr),
+            NonTargetRemapper<Index_>(),
             max_target_chunk_length,
             ticks,
             map,
@@ -717,17 +1136,17 @@ public:
             true,
             true
         ),
-        my_num_indices(idx_ptr->size())
+        my_densifier(idx_ptr->size())
     {}
 
 private:
     SparseCore<solo_, oracle_, Index_, CachedValue_, CachedIndex_> my_core;
-    Index_ my_num_indices;
+    Densifier<Value_, Index_> my_densifier;
 
 public:
-    const Value_* fetch(const Index_ i, Value_* const buffer) {
+    const Value_* fetch(const Index_ i, Value_*) {
         const auto res = my_core.fetch_raw(i);
-        return densify(*(res.first), res.second, my_num_indices, buffer);
+        return my_densifier.densify(*(res.first), res.second);
     }
 };
 
@@ -125,7 +125,57 @@ void parse_Sparse2darray(const pybind11::object& matrix, Value_* const vbuffer,
 /**
  * @cond
  */
-template<typename CachedValue_, typename CachedIndex_, typename Index_>
+// These loops are kept simple so that the compiler can vectorize them, i.e., SIMD adds and gathers.
+template<typename Input_, typename Length_, typename Shift_, typename Output_>
+void shift_indices(const Input_* const input, const Length_ length, const Shift_ shift, Output_* const output) {
+    for (Length_ i = 0; i < length; ++i) {
+        output[i] = static_cast<Shift_>(input[i]) + shift;
+    }
+}
+
+template<typename Input_, typename Length_, typename Mapping_, typename Output_>
+void gather_indices(const Input_* const input, const Length_ length, const Mapping_* const mapping, Output_* const output) {
+    for (Length_ i = 0; i < length; ++i) {
+        output[i] = mapping[input[i]];
+    }
+}
+
+// Converts indices along the non-target dimension of the extracted SVT into indices of the full matrix.
+// This is applied when populating the slab so that the extractors do not need to remap on every fetch().
+template<typename Index_>
+class NonTargetRemapper {
+public:
+    NonTargetRemapper() = default;
+    NonTargetRemapper(const Index_ shift) : my_shift(shift) {}
+    NonTargetRemapper(tatami::VectorPtr<Index_> indices) : my_indices(std::move(indices)) {}
+
+private:
+    Index_ my_shift = 0;
+    tatami::VectorPtr<Index_> my_indices;
+
+public:
+    template<typename Input_>
+    Index_ remap(const Input_ i) const {
+        if (my_indices) {
+            return (*my_indices)[i];
+        } else {
+            return static_cast<Index_>(i) + my_shift;
+        }
+    }
+
+    template<typename Input_, typename Length_, typename Output_>
+    void remap(const Input_* const input, const Length_ length, Output_* const output) const {
+        if (my_indices) {
+            gather_indices(input, length, my_indices->data(), output);
+        } else if (my_shift) {
+            shift_indices(input, length, my_shift, output);
+        } else {
+            std::copy_n(input, length, output);
+        }
+    }
+};
+
+template<typename CachedValue_, typename CachedIndex_, typename Index_, typename Remap_>
 void parse_sparse_matrix(
     const pybind11::object& matrix,
     bool row,
@@ -133,7 +183,8 @@ void parse_sparse_matrix(
     CachedValue_* const vbuffer,
     std::vector<CachedIndex_*>& index_ptrs, 
     CachedIndex_* const ibuffer,
-    Index_* const counts
+    Index_* const counts,
+    const NonTargetRemapper<Remap_>& remapper
 ) {
     const bool needs_value = !value_ptrs.empty();
     const bool needs_index = !index_ptrs.empty();
@@ -153,9 +204,10 @@ void parse_sparse_matrix(
                     }
                 }
                 if (needs_index) {
+                    const auto remapped = remapper.remap(c);
                     for (I<decltype(nnz)> i = 0; i < nnz; ++i) {
                         auto ix = ibuffer[i];
-                        index_ptrs[ix][counts[ix]] = c;
+                        index_ptrs[ix][counts[ix]] = remapped;
                     }
                 }
                 for (I<decltype(nnz)> i = 0; i < nnz; ++i) {
@@ -167,7 +219,7 @@ void parse_sparse_matrix(
                     std::copy_n(vbuffer, nnz, value_ptrs[c]);
                 }
                 if (needs_index) {
-                    std::copy_n(ibuffer, nnz, index_ptrs[c]);
+                    remapper.remap(ibuffer, nnz, index_ptrs[c]);
                 }
                 counts[c] = nnz;
             }
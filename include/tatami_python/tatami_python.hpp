@@ -2,7 +2,11 @@
 #define TATAMI_PYTHON_TATAMI_PYTHON_HPP
 
 #include "parallelize.hpp"
+#include "partition.hpp"
+#include "ticks.hpp"
+#include "orientation.hpp"
 #include "UnknownMatrix.hpp"
+#include "translate.hpp"
 
 /** 
  * @file tatami_python.hpp
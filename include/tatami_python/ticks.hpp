@@ -0,0 +1,173 @@
+#ifndef TATAMI_PYTHON_TICKS_HPP
+#define TATAMI_PYTHON_TICKS_HPP
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+/**
+ * @file ticks.hpp
+ * @brief Adjust chunk boundaries for extraction.
+ */
+
+namespace tatami_python {
+
+/**
+ * Merge adjacent chunks into virtual super-chunks that are at least a minimum length along the dimension of interest.
+ * Chunks are merged greedily from the start of the dimension, and each super-chunk is closed once it reaches `min_length`.
+ * A super-chunk is also closed early if adding the next chunk would cause it to exceed `max_length`.
+ * This is used by `UnknownMatrix` to amortize the overhead of each Python call when the chunks reported by `chunk_grid()` are very small,
+ * e.g., one row at a time for unchunked HDF5 datasets.
+ *
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * @param ticks Chunk boundaries along the dimension of interest.
+ * This should start at zero, be strictly increasing and end at the extent of the dimension.
+ * @param min_length Minimum length of each super-chunk.
+ * The last super-chunk may be shorter than this.
+ * @param max_length Maximum length of each super-chunk.
+ * This is not enforced for individual chunks that are already longer than `max_length`, which are left as they are.
+ *
+ * @return Vector of chunk boundaries, containing a subset of the entries of `ticks`.
+ * The first and last entries are always retained.
+ */
+template<typename Index_>
+std::vector<Index_> merge_chunk_ticks(const std::vector<Index_>& ticks, const Index_ min_length, const Index_ max_length) {
+    std::vector<Index_> output;
+    if (ticks.empty()) {
+        return output;
+    }
+
+    output.push_back(ticks.front());
+    for (std::size_t i = 1, end = ticks.size(); i < end; ++i) {
+        // Deciding whether to close the current super-chunk before adding the chunk ending at 'ticks[i]'.
+        // Comparisons are arranged so that they don't overflow, given that 'current <= max_length' for any super-chunk with multiple chunks.
+        const Index_ current = ticks[i - 1] - output.back();
+        if (current > 0 && (current >= min_length || current > max_length || ticks[i] - ticks[i - 1] > max_length - current)) {
+            output.push_back(ticks[i - 1]);
+        }
+    }
+
+    if (output.back() != ticks.back()) {
+        output.push_back(ticks.back());
+    }
+    return output;
+}
+
+/**
+ * Split oversized chunks so that each chunk is no longer than a maximum length along the dimension of interest.
+ * Each oversized chunk is split into the smallest number of sub-chunks of near-equal length.
+ * This is used by `UnknownMatrix` to keep the cache within its budget when the chunks reported by `chunk_grid()` are very large,
+ * e.g., a single chunk spanning the entire matrix for unchunked in-memory arrays.
+ *
+ * @tparam Index_ Integer type for the row/column indices.
+ *
+ * @param ticks Chunk boundaries along the dimension of interest.
+ * This should start at zero, be strictly increasing and end at the extent of the dimension.
+ * @param max_length Maximum length of each chunk.
+ * This should be positive.
+ *
+ * @return Vector of chunk boundaries, containing all entries of `ticks` along with any additional boundaries from splitting.
+ */
+template<typename Index_>
+std::vector<Index_> split_chunk_ticks(const std::vector<Index_>& ticks, const Index_ max_length) {
+    std::vector<Index_> output;
+    if (ticks.empty()) {
+        return output;
+    }
+
+    output.reserve(ticks.size());
+    output.push_back(ticks.front());
+    for (std::size_t i = 1, end = ticks.size(); i < end; ++i) {
+        const Index_ start = ticks[i - 1];
+        const Index_ length = ticks[i] - start;
+        if (length > max_length) {
+            const Index_ num_pieces = length / max_length + (length % max_length > 0);
+            // The first 'remainder' pieces get one extra element, which avoids any overflow when computing the offsets.
+            const Index_ quotient = length / num_pieces, remainder = length % num_pieces;
+            for (Index_ p = 1; p < num_pieces; ++p) {
+                output.push_back(start + quotient * p + (p < remainder ? p : remainder));
+            }
+        }
+        output.push_back(ticks[i]);
+    }
+
+    return output;
+}
+
+/**
+ * @brief Find the chunk containing each row/column.
+ *
+ * For regular chunk grids, i.e., where all chunks have the same length except for a possibly shorter last chunk, the chunk is found by integer division.
+ * For irregular grids, the chunk is found by binary search on the chunk boundaries.
+ * In both cases, memory usage scales with the number of chunks rather than the extent of the dimension.
+ *
+ * @tparam Index_ Integer type for the row/column indices.
+ */
+template<typename Index_>
+class ChunkLookup {
+public:
+    /**
+     * @cond
+     */
+    ChunkLookup() = default;
+    /**
+     * @endcond
+     */
+
+    /**
+     * @param ticks Chunk boundaries along the dimension of interest.
+     * This should start at zero, be strictly increasing and end at the extent of the dimension.
+     */
+    ChunkLookup(const std::vector<Index_>& ticks) {
+        const auto nticks = ticks.size();
+        if (nticks < 2) {
+            return;
+        }
+
+        my_interval = ticks[1] - ticks[0];
+        for (std::size_t i = 2; i < nticks; ++i) {
+            const Index_ length = ticks[i] - ticks[i - 1];
+            if (length != my_interval && (i + 1 < nticks || length > my_interval)) {
+                my_regular = false;
+                break;
+            }
+        }
+
+        if (!my_regular) {
+            // Skipping the first and last boundaries as they don't affect the search.
+            my_boundaries.insert(my_boundaries.end(), ticks.begin() + 1, ticks.end() - 1);
+        }
+    }
+
+private:
+    bool my_regular = true;
+    Index_ my_interval = 0;
+    std::vector<Index_> my_boundaries;
+
+public:
+    /**
+     * @param i Index of the row/column.
+     * This should be non-negative and less than the extent of the dimension.
+     * @return Index of the chunk containing `i`.
+     */
+    Index_ operator[](const Index_ i) const {
+        if (my_regular) {
+            return i / my_interval;
+        } else {
+            // Number of internal boundaries that are less than or equal to 'i', which is the same as the chunk index.
+            return std::upper_bound(my_boundaries.begin(), my_boundaries.end(), i) - my_boundaries.begin();
+        }
+    }
+
+    /**
+     * @return Whether the chunk grid is regular.
+     */
+    bool is_regular() const {
+        return my_regular;
+    }
+};
+
+}
+
+#endif
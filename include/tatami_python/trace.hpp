@@ -0,0 +1,121 @@
+#ifndef TATAMI_PYTHON_TRACE_HPP
+#define TATAMI_PYTHON_TRACE_HPP
+
+#include <vector>
+#include <mutex>
+#include <ostream>
+#include <cstddef>
+
+/**
+ * @file trace.hpp
+ * @brief Record chunk accesses for offline analysis.
+ */
+
+namespace tatami_python {
+
+/**
+ * @brief Access to a single chunk.
+ */
+struct AccessRecord {
+    /**
+     * Whether the chunk was accessed for row extraction.
+     * If false, it was accessed for column extraction.
+     */
+    bool row;
+
+    /**
+     * Index of the chunk along the target dimension, see `UnknownMatrix::chunk_ticks()`.
+     */
+    std::size_t chunk;
+
+    /**
+     * Size of the chunk in the cache, in bytes.
+     * This considers the extracted subset of the non-target dimension.
+     */
+    std::size_t bytes;
+
+    /**
+     * Identifier for the extractor that accessed the chunk, see `AccessTrace::register_extractor()`.
+     * Each extractor has its own cache, so accesses from different extractors should be simulated separately.
+     */
+    std::size_t extractor;
+
+    /**
+     * Zero if the chunk was accessed through the usual cache of the extractor.
+     * Otherwise, the chunk was accessed by a myopic extractor in read-ahead mode (see `UnknownMatrixOptions::sequential_read_ahead`),
+     * and this is the 1-based index of the read-ahead cache within that extractor.
+     * Each read-ahead cache is discarded when the extractor stops reading ahead, so accesses with different indices should be simulated separately.
+     */
+    std::size_t read_ahead;
+};
+
+/**
+ * @brief Thread-safe log of chunk accesses.
+ *
+ * Each extractor appends a record whenever it requests a row/column, in the order in which the requests are made.
+ * For oracle-aware extractors, this is the order of the predictions.
+ * The resulting trace can be replayed against different cache sizes to choose `UnknownMatrixOptions::maximum_cache_size`,
+ * e.g., with the `tools/cache_advisor.py` script.
+ */
+class AccessTrace {
+private:
+    mutable std::mutex my_lock;
+    std::vector<AccessRecord> my_records;
+    std::size_t my_num_extractors = 0;
+
+public:
+    /**
+     * @return Identifier for a new extractor, unique within this trace.
+     */
+    std::size_t register_extractor() {
+        std::lock_guard<std::mutex> lck(my_lock);
+        return my_num_extractors++;
+    }
+
+    /**
+     * @param extractor Identifier for the extractor, from `register_extractor()`.
+     * @param read_ahead Index of the read-ahead cache that accessed the chunk, or zero for the usual cache, see `AccessRecord::read_ahead`.
+     * @param row Whether the chunk was accessed for row extraction.
+     * @param chunk Index of the chunk.
+     * @param bytes Size of the chunk in the cache, in bytes.
+     */
+    void record(const std::size_t extractor, const std::size_t read_ahead, const bool row, const std::size_t chunk, const std::size_t bytes) {
+        std::lock_guard<std::mutex> lck(my_lock);
+        my_records.push_back(AccessRecord{ row, chunk, bytes, extractor, read_ahead });
+    }
+
+    /**
+     * @return Copy of all records so far.
+     */
+    std::vector<AccessRecord> records() const {
+        std::lock_guard<std::mutex> lck(my_lock);
+        return my_records;
+    }
+
+    /**
+     * Remove all records.
+     */
+    void clear() {
+        std::lock_guard<std::mutex> lck(my_lock);
+        my_records.clear();
+    }
+};
+
+/**
+ * Write chunk accesses to a CSV file, e.g., for replay with the `tools/cache_advisor.py` script.
+ * This contains a header line followed by one line per record, with the `extractor`, `read_ahead`, `row`, `chunk` and `bytes` columns.
+ * Boolean values are written as 0 or 1.
+ *
+ * @param records Chunk accesses, typically from `UnknownMatrix::access_trace()`.
+ * @param output Stream to write to.
+ */
+inline void write_access_trace(const std::vector<AccessRecord>& records, std::ostream& output) {
+    output << "extractor,read_ahead,row,chunk,bytes\n";
+    for (const auto& rec : records) {
+        output << rec.extractor << "," << rec.read_ahead << "," << static_cast<int>(rec.row) << "," << rec.chunk << "," << rec.bytes << "\n";
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,445 @@
+#ifndef TATAMI_PYTHON_TRANSLATE_HPP
+#define TATAMI_PYTHON_TRANSLATE_HPP
+
+#include "pybind11/pybind11.h"
+#include "pybind11/numpy.h"
+#include "tatami/tatami.hpp"
+#include "sanisizer/sanisizer.hpp"
+
+#include "UnknownMatrix.hpp"
+#include "parallelize.hpp"
+#include "sparse_matrix.hpp"
+#include "utils.hpp"
+
+#ifdef TATAMI_PYTHON_USE_HDF5
+#include "hdf5.hpp"
+#endif
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <optional>
+#include <cstddef>
+
+/**
+ * @file translate.hpp
+ * @brief Translate **delayedarray** operations into native **tatami** operations.
+ */
+
+namespace tatami_python {
+
+/**
+ * @brief Result of `translate_delayed()`.
+ *
+ * @tparam Value_ Numeric type of data value for the interface.
+ * @tparam Index_ Integer type for the row/column indices, for the interface.
+ */
+template<typename Value_, typename Index_>
+struct DelayedTranslation {
+    /**
+     * Translated matrix.
+     */
+    std::shared_ptr<const tatami::Matrix<Value_, Index_> > matrix;
+
+    /**
+     * Number of delayed operations that were translated into native **tatami** wrappers.
+     */
+    std::size_t native_operations = 0;
+
+    /**
+     * Number of seeds that were replaced by native **tatami** matrices,
+     * either by wrapping or copying their contents or by opening their HDF5 files directly (see `open_hdf5_seed()`).
+     */
+    std::size_t native_seeds = 0;
+
+    /**
+     * Number of objects that could not be translated and were wrapped in an `UnknownMatrix` instead.
+     */
+    std::size_t unknown_leaves = 0;
+};
+
+/**
+ * @cond
+ */
+// Read-only view of a contiguous NumPy array, for use as the storage of a tatami::DenseMatrix.
+// This holds a reference to the array so that its buffer stays alive for the lifetime of the matrix.
+template<typename Type_>
+class NumpyArrayView {
+public:
+    NumpyArrayView(pybind11::array array) :
+        my_ptr(static_cast<const Type_*>(array.data())),
+        my_size(array.size()),
+        my_array(std::move(array))
+    {}
+
+    // Copies are only made when the matrix is constructed, i.e., while the caller holds the GIL.
+    NumpyArrayView(const NumpyArrayView&) = default;
+    NumpyArrayView& operator=(const NumpyArrayView&) = default;
+    NumpyArrayView(NumpyArrayView&&) = default;
+    NumpyArrayView& operator=(NumpyArrayView&&) = default;
+
+    ~NumpyArrayView() {
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN
+        // The matrix might be destroyed in a worker thread, so we need to serialize the decrement of the reference count.
+        if (my_array.has_value() && *my_array) {
+            TATAMI_PYTHON_SERIALIZE([&]() -> void {
+                my_array.reset();
+            });
+        }
+#endif
+    }
+
+public:
+    typedef Type_ value_type;
+
+    std::size_t size() const {
+        return my_size;
+    }
+
+    const Type_* data() const {
+        return my_ptr;
+    }
+
+    const Type_* begin() const {
+        return my_ptr;
+    }
+
+    const Type_* end() const {
+        return my_ptr + my_size;
+    }
+
+    const Type_& operator[](const std::size_t i) const {
+        return my_ptr[i];
+    }
+
+private:
+    const Type_* my_ptr;
+    std::size_t my_size;
+    std::optional<pybind11::array> my_array;
+};
+
+template<typename Value_, typename Index_, typename CachedValue_, typename CachedIndex_>
+class DelayedTranslator {
+public:
+    DelayedTranslator(const UnknownMatrixOptions& opt, DelayedTranslation<Value_, Index_>& output) :
+        my_options(opt),
+        my_output(output),
+        my_module(pybind11::module::import("delayedarray")),
+        my_numpy(pybind11::module::import("numpy"))
+    {}
+
+private:
+    const UnknownMatrixOptions& my_options;
+    DelayedTranslation<Value_, Index_>& my_output;
+    pybind11::module my_module, my_numpy;
+
+    typedef std::shared_ptr<const tatami::Matrix<Value_, Index_> > MatrixPtr;
+    typedef std::shared_ptr<const tatami::DelayedUnaryIsometricOperationHelper<Value_, Value_, Index_> > HelperPtr;
+
+    bool is_instance(const pybind11::object& x, const char* cls) const {
+        // Classes may be missing in older versions of delayedarray, in which case nothing is translated.
+        auto type = pybind11::getattr(my_module, cls, pybind11::none());
+        return !type.is_none() && pybind11::isinstance(x, type);
+    }
+
+    bool has_numeric_dtype(const pybind11::object& x) const {
+        const auto kind = pybind11::dtype(x.attr("dtype")).kind();
+        return kind == 'b' || kind == 'i' || kind == 'u' || kind == 'f';
+    }
+
+    MatrixPtr unknown(const pybind11::object& x) {
+        ++my_output.unknown_leaves;
+        return std::make_shared<UnknownMatrix<Value_, Index_, CachedValue_, CachedIndex_> >(x, my_options);
+    }
+
+public:
+    MatrixPtr translate(const pybind11::object& x) {
+        if (is_instance(x, "DelayedArray")) {
+            return translate(x.attr("seed"));
+        }
+
+        if (pybind11::isinstance<pybind11::array>(x)) {
+            return translate_dense(x);
+        }
+        if (is_instance(x, "SparseNdarray")) {
+            return translate_sparse(x);
+        }
+
+        if (is_instance(x, "Subset")) {
+            return translate_subset(x);
+        }
+        if (is_instance(x, "Transpose")) {
+            return translate_transpose(x);
+        }
+        if (is_instance(x, "Combine")) {
+            return translate_combine(x);
+        }
+        if (is_instance(x, "UnaryIsometricOpWithArgs")) {
+            return translate_arithmetic(x);
+        }
+        if (is_instance(x, "UnaryIsometricOpSimple")) {
+            return translate_simple(x);
+        }
+
+#ifdef TATAMI_PYTHON_USE_HDF5
+        auto hdf5 = open_hdf5_seed<Value_, Index_, CachedValue_, CachedIndex_>(x, my_options);
+        if (hdf5) {
+            ++my_output.native_seeds;
+            return hdf5;
+        }
+#endif
+
+        return unknown(x);
+    }
+
+private:
+    MatrixPtr translate_dense(const pybind11::object& x) {
+        pybind11::array arr(x);
+        if (arr.ndim() != 2 || !has_numeric_dtype(x)) {
+            return unknown(x);
+        }
+
+        // Preserving the existing layout to avoid a transposition in NumPy.
+        // Both calls are no-ops that return the original array if it already has the right type and a contiguous layout,
+        // in which case the matrix is a view of the original buffer; otherwise, it views the converted copy.
+        arr = pybind11::array(my_numpy.attr("asarray")(arr, pybind11::dtype::of<CachedValue_>()));
+        bool row_major = true;
+        if (arr.flags() & pybind11::array::f_style) {
+            row_major = false;
+        } else if (!(arr.flags() & pybind11::array::c_style)) {
+            arr = pybind11::array(my_numpy.attr("ascontiguousarray")(arr));
+        }
+
+        const auto shape = get_shape<Index_>(x);
+        ++my_output.native_seeds;
+        return std::make_shared<tatami::DenseMatrix<Value_, Index_, NumpyArrayView<CachedValue_> > >(
+            shape.first,
+            shape.second,
+            NumpyArrayView<CachedValue_>(std::move(arr)),
+            row_major
+        );
+    }
+
+    MatrixPtr translate_sparse(const pybind11::object& x) {
+        const auto shape = get_shape<Index_>(x);
+        if (!has_numeric_dtype(x) || pybind11::dtype(x.attr("dtype")).kind() == 'b') {
+            return unknown(x); // dump_to_buffer() does not support booleans.
+        }
+
+        auto vbuffer = sanisizer::create<std::vector<CachedValue_> >(shape.first);
+        auto ibuffer = sanisizer::create<std::vector<CachedIndex_> >(shape.first);
+        std::vector<CachedValue_> values;
+        std::vector<CachedIndex_> indices;
+        auto pointers = sanisizer::create<std::vector<std::size_t> >(sanisizer::sum<std::size_t>(shape.second, 1));
+
+        parse_Sparse2darray(x, vbuffer.data(), ibuffer.data(), [&](const Index_ c, const Index_ n) -> void {
+            values.insert(values.end(), vbuffer.begin(), vbuffer.begin() + n);
+            indices.insert(indices.end(), ibuffer.begin(), ibuffer.begin() + n);
+            pointers[c + 1] = n;
+        });
+        for (Index_ c = 0; c < shape.second; ++c) {
+            pointers[c + 1] += pointers[c];
+        }
+
+        ++my_output.native_seeds;
+        return std::make_shared<tatami::CompressedSparseMatrix<Value_, Index_, std::vector<CachedValue_>, std::vector<CachedIndex_>, std::vector<std::size_t> > >(
+            shape.first,
+            shape.second,
+            std::move(values),
+            std::move(indices),
+            std::move(pointers),
+            false
+        );
+    }
+
+    MatrixPtr translate_subset(const pybind11::object& x) {
+        auto subset = x.attr("subset").template cast<pybind11::tuple>();
+        if (subset.size() != 2) {
+            return unknown(x);
+        }
+
+        auto current = translate(x.attr("seed"));
+        for (int d = 0; d < 2; ++d) {
+            const bool by_row = (d == 0);
+            auto arr = my_numpy.attr("asarray")(subset[d], pybind11::dtype::of<Index_>()).template cast<pybind11::array_t<Index_> >();
+            const auto ptr = static_cast<const Index_*>(arr.request().ptr);
+            std::vector<Index_> indices(ptr, ptr + arr.size());
+
+            // Skipping the subset if it is a no-op, which is common for subsets along only one dimension.
+            const Index_ extent = (by_row ? current->nrow() : current->ncol());
+            bool noop = sanisizer::is_equal(indices.size(), extent);
+            for (I<decltype(indices.size())> i = 0, end = indices.size(); noop && i < end; ++i) {
+                noop = sanisizer::is_equal(indices[i], i);
+            }
+            if (noop) {
+                continue;
+            }
+
+            current = std::make_shared<tatami::DelayedSubset<Value_, Index_, std::vector<Index_> > >(std::move(current), std::move(indices), by_row);
+            ++my_output.native_operations;
+        }
+
+        return current;
+    }
+
+    MatrixPtr translate_transpose(const pybind11::object& x) {
+        auto perm = x.attr("perm").template cast<pybind11::tuple>();
+        if (perm.size() != 2) {
+            return unknown(x);
+        }
+
+        auto current = translate(x.attr("seed"));
+        if (perm[0].template cast<int>() == 0) {
+            return current;
+        }
+        ++my_output.native_operations;
+        return std::make_shared<tatami::DelayedTranspose<Value_, Index_> >(std::move(current));
+    }
+
+    MatrixPtr translate_combine(const pybind11::object& x) {
+        const auto along = x.attr("along").template cast<int>();
+        if (along != 0 && along != 1) {
+            return unknown(x);
+        }
+
+        auto seeds = x.attr("seeds").template cast<pybind11::list>();
+        std::vector<MatrixPtr> children;
+        children.reserve(seeds.size());
+        for (I<decltype(seeds.size())> s = 0, end = seeds.size(); s < end; ++s) {
+            children.push_back(translate(seeds[s]));
+        }
+
+        ++my_output.native_operations;
+        return std::make_shared<tatami::DelayedBind<Value_, Index_> >(std::move(children), along == 0);
+    }
+
+    template<tatami::ArithmeticOperation op_, bool right_>
+    static HelperPtr arithmetic_helper(const std::optional<Value_>& scalar, std::vector<Value_> vector, const bool by_row) {
+        if (scalar.has_value()) {
+            return std::make_shared<tatami::DelayedUnaryIsometricArithmeticScalarHelper<op_, right_, Value_, Value_, Index_, Value_> >(*scalar);
+        } else {
+            return std::make_shared<tatami::DelayedUnaryIsometricArithmeticVectorHelper<op_, right_, Value_, Value_, Index_, std::vector<Value_> > >(std::move(vector), by_row);
+        }
+    }
+
+    template<tatami::ArithmeticOperation op_>
+    static HelperPtr arithmetic_helper(const bool right, const std::optional<Value_>& scalar, std::vector<Value_> vector, const bool by_row) {
+        if (right) {
+            return arithmetic_helper<op_, true>(scalar, std::move(vector), by_row);
+        } else {
+            return arithmetic_helper<op_, false>(scalar, std::move(vector), by_row);
+        }
+    }
+
+    MatrixPtr translate_arithmetic(const pybind11::object& x) {
+        const auto operation = x.attr("operation").template cast<std::string>();
+        const auto right = x.attr("right").template cast<bool>();
+
+        // Scalars are stored as 1-element arrays, while vectors are applied along the 'along' dimension.
+        auto value = my_numpy.attr("ravel")(my_numpy.attr("asarray")(x.attr("value"), pybind11::dtype::of<Value_>())).template cast<pybind11::array_t<Value_> >();
+        const auto vptr = static_cast<const Value_*>(value.request().ptr);
+        std::optional<Value_> scalar;
+        std::vector<Value_> vector;
+        bool by_row = false;
+        if (value.size() == 1) {
+            scalar = vptr[0];
+        } else {
+            auto raw_along = x.attr("along");
+            if (raw_along.is_none()) {
+                return unknown(x);
+            }
+            const auto along = raw_along.template cast<int>();
+            if (along != 0 && along != 1) {
+                return unknown(x);
+            }
+            by_row = (along == 0);
+            const auto shape = get_shape<Index_>(x);
+            if (!sanisizer::is_equal(value.size(), by_row ? shape.first : shape.second)) {
+                return unknown(x);
+            }
+            vector.insert(vector.end(), vptr, vptr + value.size());
+        }
+
+        // Operation names are those used by delayedarray's UnaryIsometricOpWithArgs, not the Python operators.
+        HelperPtr helper;
+        if (operation == "add") {
+            helper = arithmetic_helper<tatami::ArithmeticOperation::ADD>(right, scalar, std::move(vector), by_row);
+        } else if (operation == "subtract") {
+            helper = arithmetic_helper<tatami::ArithmeticOperation::SUBTRACT>(right, scalar, std::move(vector), by_row);
+        } else if (operation == "multiply") {
+            helper = arithmetic_helper<tatami::ArithmeticOperation::MULTIPLY>(right, scalar, std::move(vector), by_row);
+        } else if (operation == "divide") {
+            helper = arithmetic_helper<tatami::ArithmeticOperation::DIVIDE>(right, scalar, std::move(vector), by_row);
+        } else if (operation == "power") {
+            helper = arithmetic_helper<tatami::ArithmeticOperation::POWER>(right, scalar, std::move(vector), by_row);
+        } else if (operation == "remainder") {
+            helper = arithmetic_helper<tatami::ArithmeticOperation::MODULO>(right, scalar, std::move(vector), by_row);
+        } else if (operation == "floor_divide") {
+            helper = arithmetic_helper<tatami::ArithmeticOperation::INTEGER_DIVIDE>(right, scalar, std::move(vector), by_row);
+        } else {
+            return unknown(x);
+        }
+
+        ++my_output.native_operations;
+        return std::make_shared<tatami::DelayedUnaryIsometricOperation<Value_, Value_, Index_> >(translate(x.attr("seed")), std::move(helper));
+    }
+
+    MatrixPtr translate_simple(const pybind11::object& x) {
+        const auto operation = x.attr("operation").template cast<std::string>();
+        HelperPtr helper;
+        if (operation == "log1p") {
+            helper = std::make_shared<tatami::DelayedUnaryIsometricLog1pHelper<Value_, Value_, Index_, Value_> >();
+        } else {
+            return unknown(x);
+        }
+
+        ++my_output.native_operations;
+        return std::make_shared<tatami::DelayedUnaryIsometricOperation<Value_, Value_, Index_> >(translate(x.attr("seed")), std::move(helper));
+    }
+};
+/**
+ * @endcond
+ */
+
+/**
+ * Translate a `DelayedArray` from the **delayedarray** package into the equivalent native **tatami** delayed operations.
+ * This walks the graph of delayed operations and rebuilds each supported operation as a **tatami** wrapper:
+ *
+ * - `Subset` becomes a `tatami::DelayedSubset` for each subsetted dimension.
+ * - `Transpose` becomes a `tatami::DelayedTranspose`.
+ * - `Combine` becomes a `tatami::DelayedBind`.
+ * - `UnaryIsometricOpWithArgs` becomes a `tatami::DelayedUnaryIsometricOperation` for scalar or vector arithmetic,
+ *   i.e., the `add`, `subtract`, `multiply`, `divide`, `power`, `remainder` and `floor_divide` operations (`+`, `-`, `*`, `/`, `**`, `%` and `//`, respectively).
+ * - `UnaryIsometricOpSimple` becomes a `tatami::DelayedUnaryIsometricOperation` for `log1p`.
+ * .
+ * NumPy arrays at the leaves of the graph are wrapped in a `tatami::DenseMatrix` without copying, unless they need to be converted to `CachedValue_` or made contiguous.
+ * The matrix holds a reference to the array, so the array should not be modified in Python while the matrix is in use.
+ * `SparseNdarray`s at the leaves are copied into a `tatami::CompressedSparseMatrix`.
+ * If the `TATAMI_PYTHON_USE_HDF5` macro is defined, HDF5-backed seeds are opened with the HDF5 C library via `open_hdf5_seed()`.
+ * All other operations and seeds are wrapped in an `UnknownMatrix`, so that they are still evaluated in Python.
+ * If the entire graph is translated, no calls to Python are required for data extraction.
+ *
+ * This function should only be called when the current thread is holding the GIL.
+ *
+ * @tparam Value_ Numeric type of data value for the interface.
+ * @tparam Index_ Integer type for the row/column indices, for the interface.
+ * @tparam CachedValue_ Numeric type of data value for the native seeds and the caches of each `UnknownMatrix`.
+ * @tparam CachedIndex_ Integer type for the row/column indices for the native seeds and the caches of each `UnknownMatrix`.
+ *
+ * @param seed A matrix-like Python object, typically a `DelayedArray`.
+ * @param opt Extraction options for each `UnknownMatrix`.
+ * Note that each `UnknownMatrix` has its own cache of up to `UnknownMatrixOptions::maximum_cache_size`.
+ *
+ * @return The translated matrix, along with the number of native operations, native seeds and `UnknownMatrix` leaves.
+ */
+template<typename Value_, typename Index_, typename CachedValue_ = Value_, typename CachedIndex_ = Index_>
+DelayedTranslation<Value_, Index_> translate_delayed(const pybind11::object& seed, const UnknownMatrixOptions& opt) {
+    DelayedTranslation<Value_, Index_> output;
+    DelayedTranslator<Value_, Index_, CachedValue_, CachedIndex_> translator(opt, output);
+    output.matrix = translator.translate(seed);
+    return output;
+}
+
+}
+
+#endif
@@ -9,15 +9,96 @@
 #include <stdexcept>
 #include <memory>
 #include <numeric>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <atomic>
+#include <limits>
 
 #include "tatami/tatami.hpp"
+#include "tatami_chunked/tatami_chunked.hpp"
 #include "sanisizer/sanisizer.hpp"
 
+#include "cache_policy.hpp"
+#include "trace.hpp"
+#include "memory.hpp"
+
 namespace tatami_python { 
 
 template<typename Input_>
 using I = std::remove_reference_t<std::remove_cv_t<Input_> >;
 
+// Instrumentation counters that are shared by all extractors of an UnknownMatrix.
+// These are atomic as extractors may be used in different threads, but we only need relaxed ordering as they are purely informational.
+struct CoreCounters {
+    std::atomic<std::size_t> chunk_loads{0};
+    std::atomic<std::size_t> element_loads{0};
+    std::atomic<std::size_t> switches_to_element{0};
+    std::atomic<std::size_t> switches_to_chunk{0};
+    std::atomic<std::size_t> switches_to_read_ahead{0};
+};
+
+inline void increment_counter(std::atomic<std::size_t>& counter, const std::size_t by = 1) {
+    counter.fetch_add(by, std::memory_order_relaxed);
+}
+
+// Settings from the UnknownMatrix that are shared by all of its extractors.
+// The cores hold a reference to this, so it should live as long as the UnknownMatrix.
+struct CoreOptions {
+    bool thread_safe = false;
+    std::optional<pybind11::object> executor;
+    std::size_t max_in_flight = 1;
+
+    // Event loop for extractors that return awaitables, along with a cached asyncio.run_coroutine_threadsafe.
+    std::optional<pybind11::object> event_loop;
+    std::optional<pybind11::object> run_coroutine;
+
+    bool use_out = false;
+
+    std::optional<pybind11::object> dense_chunk_extractor;
+    std::optional<pybind11::object> sparse_chunk_extractor;
+
+    bool adaptive_granularity = false;
+    bool read_ahead = false;
+    CachePolicy cache_policy = CachePolicy::LRU;
+    std::size_t maximum_staging_elements = 0;
+    std::size_t maximum_batch_elements = 0;
+    std::size_t minimum_batch_elements = 0; // left at zero if a cache budget is used, as the minimum is folded into the demand instead, see UnknownMatrix::reserve_cache().
+    mutable CoreCounters counters;
+
+    // Bytes held by all cores, along with the optional limit on in-flight results.
+    mutable MemoryTracker memory;
+
+    // Only set if chunk accesses should be recorded.
+    std::unique_ptr<AccessTrace> trace;
+};
+
+// Identifies the cache that served each access in the trace.
+// Each read-ahead core of a myopic extractor uses the same extractor ID as its parent, but has a separate cache, see AccessRecord::read_ahead.
+struct TraceTag {
+    std::size_t extractor = 0;
+    std::size_t read_ahead = 0;
+};
+
+inline TraceTag create_trace_tag(const CoreOptions& options) {
+    TraceTag output;
+    if (options.trace) {
+        output.extractor = options.trace->register_extractor();
+    }
+    return output;
+}
+
+// 'target_bytes' is the size of each row/column of the chunk in the cache.
+template<typename Index_>
+void record_access(const CoreOptions& options, const TraceTag& tag, const bool row, const std::vector<Index_>& ticks, const Index_ chunk, const std::size_t target_bytes) {
+    if (options.trace) {
+        const std::size_t chunk_len = ticks[chunk + 1] - ticks[chunk];
+        options.trace->record(tag.extractor, tag.read_ahead, row, chunk, chunk_len * target_bytes);
+    }
+}
+
 inline std::string get_class_name(const pybind11::object& incoming) {
     if (!pybind11::hasattr(incoming, "__class__")) {
         return "unknown";
@@ -72,6 +153,180 @@ pybind11::array_t<Index_> create_indexing_array(const std::vector<Index_>& indic
     return output;
 }
 
+inline pybind11::object submit_coroutine(const CoreOptions& options, const pybind11::object& coroutine) {
+    // Returns a concurrent.futures.Future, so it can be treated in the same manner as the executor's futures.
+    return (*(options.run_coroutine))(coroutine, *(options.event_loop));
+}
+
+inline pybind11::object call_extractor(const pybind11::object& extractor, const pybind11::object& matrix, const CoreOptions& options, const pybind11::tuple& args) {
+    if (options.event_loop.has_value()) {
+        // Python's Future.result() releases the GIL while waiting, so the event loop's thread can run the coroutine.
+        return submit_coroutine(options, extractor(matrix, args)).attr("result")();
+    } else {
+        return extractor(matrix, args);
+    }
+}
+
+inline pybind11::object invoke_extractor(const pybind11::object& extractor, const CoreOptions& options, const pybind11::tuple& args) {
+    if (options.event_loop.has_value()) {
+        return submit_coroutine(options, extractor(*args)).attr("result")();
+    } else {
+        return extractor(*args);
+    }
+}
+
+inline pybind11::tuple create_extract_args(const pybind11::tuple& existing, const bool row, pybind11::object primary_extract) {
+    // Creating a new tuple so that each in-flight call has its own arguments.
+    pybind11::tuple output(2);
+    output[static_cast<int>(row)] = existing[static_cast<int>(row)];
+    output[static_cast<int>(!row)] = std::move(primary_extract);
+    return output;
+}
+
+// Extracts a batch of chunks, possibly splitting it into groups of consecutive chunks that are submitted to an executor or an event loop.
+// This keeps multiple calls in flight at once, so that backends that release the GIL during I/O (or are asynchronous) can overlap their requests.
+// While we wait on each future, the GIL is released by Python's own Future.result(), allowing the executor's threads or the event loop to proceed.
+// 'args(first, last)' should return all positional arguments to 'extractor' for extraction of the chunks in [first, last),
+// and 'parse(first, last, obj)' should parse the result of that extraction.
+template<class Args_, class Parse_>
+void extract_in_flight(
+    const pybind11::object& extractor,
+    const CoreOptions& options,
+    const std::size_t num_chunks,
+    Args_ args,
+    Parse_ parse
+) {
+    std::size_t num_groups = 1;
+    if (options.executor.has_value() || options.event_loop.has_value()) {
+        num_groups = std::min(num_chunks, std::max(options.max_in_flight, static_cast<std::size_t>(1)));
+    }
+
+    if (num_groups <= 1) {
+        const auto obj = invoke_extractor(extractor, options, args(0, num_chunks));
+        parse(0, num_chunks, obj);
+        return;
+    }
+
+    std::vector<pybind11::object> futures;
+    futures.reserve(num_groups);
+    for (std::size_t g = 0; g < num_groups; ++g) {
+        const auto first = (num_chunks * g) / num_groups, last = (num_chunks * (g + 1)) / num_groups;
+        if (options.event_loop.has_value()) {
+            // The event loop takes precedence as the extractor's awaitables need to be run there.
+            futures.push_back(submit_coroutine(options, extractor(*args(first, last))));
+        } else {
+            futures.push_back(options.executor->attr("submit")(extractor, *args(first, last)));
+        }
+    }
+
+    for (std::size_t g = 0; g < num_groups; ++g) {
+        const auto first = (num_chunks * g) / num_groups, last = (num_chunks * (g + 1)) / num_groups;
+        const auto obj = futures[g].attr("result")();
+        parse(first, last, obj);
+    }
+}
+
+// Maximum number of rows/columns along the target dimension in each call from an oracle-aware core, see CoreOptions::maximum_batch_elements.
+inline std::size_t max_batch_length(const CoreOptions& options, const std::size_t non_target_length) {
+    if (options.maximum_batch_elements == 0 || non_target_length == 0) {
+        return std::numeric_limits<std::size_t>::max();
+    }
+    return std::max(options.maximum_batch_elements / non_target_length, static_cast<std::size_t>(1));
+}
+
+// Enlarges the cache of an oracle-aware core so that each batch can contain at least 'minimum' elements, see CoreOptions::minimum_batch_elements.
+// Only missing chunks are requested in each batch, so a batch may still contain fewer elements if some of the upcoming chunks are already cached.
+// The enlarged cache may exceed the cache size that was used to compute 'stats'.
+// This is used for the oracle-aware extractors as well as the read-ahead cores of the myopic extractors.
+template<typename Index_>
+void enforce_minimum_batch(tatami_chunked::SlabCacheStats<Index_>& stats, const Index_ num_chunks, const std::size_t minimum) {
+    if (minimum == 0 || stats.max_slabs_in_cache == 0 || stats.slab_size_in_elements == 0) {
+        return;
+    }
+    const std::size_t needed = minimum / stats.slab_size_in_elements + (minimum % stats.slab_size_in_elements > 0);
+    stats.max_slabs_in_cache = std::max(stats.max_slabs_in_cache, std::min(needed, static_cast<std::size_t>(num_chunks)));
+}
+
+// Same as extract_in_flight(), but the batch is first split into groups of consecutive chunks, see extract_within_limit() for details.
+// 'length(x)' should return the length of the x-th chunk along the target dimension, and 'args' and 'parse' are the same as for extract_in_flight().
+template<class Length_, class Args_, class Parse_>
+void extract_in_flight_within_limit(
+    const pybind11::object& extractor,
+    const CoreOptions& options,
+    const std::size_t num_chunks,
+    Length_ length,
+    const std::size_t target_bytes,
+    const std::size_t max_length,
+    Args_ args,
+    Parse_ parse
+) {
+    extract_within_limit(
+        options.memory,
+        num_chunks,
+        std::move(length),
+        target_bytes,
+        max_length,
+        [&](const std::size_t start, const std::size_t end) -> void {
+            extract_in_flight(
+                extractor,
+                options,
+                end - start,
+                [&](const std::size_t first, const std::size_t last) -> pybind11::tuple {
+                    return args(start + first, start + last);
+                },
+                [&](const std::size_t first, const std::size_t last, const pybind11::object& obj) -> void {
+                    parse(start + first, start + last, obj);
+                }
+            );
+        }
+    );
+}
+
+// Arguments for the chunk extraction functions, i.e., (matrix, ranges, non_target, axis).
+// 'ranges' is a list of (start, length) tuples for each chunk along the target dimension, and 'axis' is the target dimension.
+template<typename Index_, typename Slab_>
+pybind11::tuple create_chunk_args(
+    const pybind11::object& matrix,
+    const std::vector<std::pair<Index_, Slab_*> >& to_populate,
+    const std::size_t first,
+    const std::size_t last,
+    const std::vector<Index_>& ticks,
+    const pybind11::tuple& existing,
+    const bool row
+) {
+    pybind11::list ranges(last - first);
+    for (auto x = first; x < last; ++x) {
+        const auto id = to_populate[x].first;
+        ranges[x - first] = pybind11::make_tuple(ticks[id], ticks[id + 1] - ticks[id]);
+    }
+    return pybind11::make_tuple(matrix, std::move(ranges), existing[static_cast<int>(row)], static_cast<int>(!row));
+}
+
+// Chunk extraction functions may return one result per range, or a single concatenated result for all ranges.
+// This returns the former if present, otherwise an empty optional.
+inline std::optional<pybind11::sequence> split_chunk_results(const pybind11::object& obj, const std::size_t num_ranges) {
+    if (!pybind11::isinstance<pybind11::list>(obj) && !pybind11::isinstance<pybind11::tuple>(obj)) {
+        return std::nullopt;
+    }
+    auto parts = obj.template cast<pybind11::sequence>();
+    if (parts.size() != num_ranges) {
+        throw std::runtime_error("chunk extraction function should return one result per requested range");
+    }
+    return parts;
+}
+
+template<typename Value_, typename CachedValue_, typename Length_>
+const Value_* fetch_from_cache(const CachedValue_* const cached, const Length_ length, Value_* const buffer) {
+    // If the types are the same, we can just return a pointer into the cache without any copying.
+    // This remains valid until the next fetch() call, at which point the slab may be evicted or repopulated.
+    if constexpr(std::is_same<Value_, CachedValue_>::value) {
+        return cached;
+    } else {
+        std::copy_n(cached, length, buffer);
+        return buffer;
+    }
+}
+
 }
 
 #endif
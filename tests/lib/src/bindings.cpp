@@ -2,6 +2,9 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <fstream>
+#include <stdexcept>
 
 #ifdef TEST_CUSTOM_PARALLEL
 #define TATAMI_PYTHON_PARALLELIZE_UNKNOWN
@@ -18,14 +21,172 @@ void free_test(std::uintptr_t ptr0) {
     return;
 }
 
-std::uintptr_t parse_test(pybind11::object seed, double cache_size, bool require_min) {
+std::uintptr_t create_cache_budget(const double total, const std::size_t expected) {
+    auto ptr = new std::shared_ptr<tatami_python::CacheBudget>(new tatami_python::CacheBudget(total, expected));
+    return reinterpret_cast<std::uintptr_t>(ptr);
+}
+
+void free_cache_budget(const std::uintptr_t ptr0) {
+    delete reinterpret_cast<std::shared_ptr<tatami_python::CacheBudget>*>(ptr0);
+}
+
+pybind11::dict cache_budget_stats(const std::uintptr_t ptr0) {
+    const auto& budget = *reinterpret_cast<std::shared_ptr<tatami_python::CacheBudget>*>(ptr0);
+    pybind11::dict output;
+    output["total"] = budget->total();
+    output["reserved"] = budget->reserved();
+    output["peak_reserved"] = budget->peak_reserved();
+    output["active"] = budget->active();
+    return output;
+}
+
+// Number of bytes reserved from the budget while a single dense extractor is alive.
+std::size_t reserved_by_extractor(const std::uintptr_t mat_ptr0, const std::uintptr_t budget_ptr0, const bool row) {
+    const auto mat_ptr = reinterpret_cast<TestMatrix*>(mat_ptr0);
+    const auto& budget = *reinterpret_cast<std::shared_ptr<tatami_python::CacheBudget>*>(budget_ptr0);
+    auto ext = mat_ptr->dense(row, tatami::Options());
+    return budget->reserved();
+}
+
+tatami_python::CachePolicy parse_cache_policy(const std::string& policy) {
+    if (policy == "2q") {
+        return tatami_python::CachePolicy::TWO_QUEUE;
+    } else if (policy == "lfu") {
+        return tatami_python::CachePolicy::LFU;
+    } else if (policy == "lru") {
+        return tatami_python::CachePolicy::LRU;
+    }
+    throw std::runtime_error("unknown cache policy '" + policy + "'");
+}
+
+tatami_python::UnknownMatrixOptions parse_options(double cache_size, bool require_min, const pybind11::dict& extra) {
     tatami_python::UnknownMatrixOptions opt;
     opt.maximum_cache_size = cache_size;
     opt.require_minimum_cache = require_min;
+    if (extra.contains("thread_safe")) {
+        opt.thread_safe = extra["thread_safe"].cast<bool>();
+    }
+    if (extra.contains("dense_extractor")) {
+        opt.dense_extractor = pybind11::object(extra["dense_extractor"]);
+    }
+    if (extra.contains("sparse_extractor")) {
+        opt.sparse_extractor = pybind11::object(extra["sparse_extractor"]);
+    }
+    if (extra.contains("executor")) {
+        opt.executor = pybind11::object(extra["executor"]);
+    }
+    if (extra.contains("event_loop")) {
+        opt.event_loop = pybind11::object(extra["event_loop"]);
+    }
+    if (extra.contains("dense_chunk_extractor")) {
+        opt.dense_chunk_extractor = pybind11::object(extra["dense_chunk_extractor"]);
+    }
+    if (extra.contains("sparse_chunk_extractor")) {
+        opt.sparse_chunk_extractor = pybind11::object(extra["sparse_chunk_extractor"]);
+    }
+    if (extra.contains("minimum_chunk_elements")) {
+        opt.minimum_chunk_elements = extra["minimum_chunk_elements"].cast<std::size_t>();
+    }
+    if (extra.contains("split_oversized_chunks")) {
+        opt.split_oversized_chunks = extra["split_oversized_chunks"].cast<bool>();
+    }
+    if (extra.contains("adaptive_granularity")) {
+        opt.adaptive_granularity = extra["adaptive_granularity"].cast<bool>();
+    }
+    if (extra.contains("sequential_read_ahead")) {
+        opt.sequential_read_ahead = extra["sequential_read_ahead"].cast<bool>();
+    }
+    if (extra.contains("cache_policy")) {
+        opt.cache_policy = parse_cache_policy(extra["cache_policy"].cast<std::string>());
+    }
+    if (extra.contains("record_trace")) {
+        opt.record_trace = extra["record_trace"].cast<bool>();
+    }
+    if (extra.contains("cache_budget")) {
+        opt.cache_budget = *reinterpret_cast<std::shared_ptr<tatami_python::CacheBudget>*>(extra["cache_budget"].cast<std::uintptr_t>());
+    }
+    if (extra.contains("memory_limit")) {
+        opt.memory_limit = extra["memory_limit"].cast<std::size_t>();
+    }
+    if (extra.contains("maximum_staging_elements")) {
+        opt.maximum_staging_elements = extra["maximum_staging_elements"].cast<std::size_t>();
+    }
+    if (extra.contains("minimum_batch_elements")) {
+        opt.minimum_batch_elements = extra["minimum_batch_elements"].cast<std::size_t>();
+    }
+    if (extra.contains("maximum_batch_elements")) {
+        opt.maximum_batch_elements = extra["maximum_batch_elements"].cast<std::size_t>();
+    }
+    if (extra.contains("probe_orientation")) {
+        opt.probe_orientation = extra["probe_orientation"].cast<bool>();
+    }
+    if (extra.contains("use_out")) {
+        opt.use_out = extra["use_out"].cast<bool>();
+    }
+    if (extra.contains("max_in_flight")) {
+        opt.max_in_flight = extra["max_in_flight"].cast<std::size_t>();
+    }
+    return opt;
+}
+
+std::uintptr_t parse_test(pybind11::object seed, double cache_size, bool require_min, const pybind11::dict& extra) {
+    auto opt = parse_options(cache_size, require_min, extra);
+    if (extra.contains("narrow_cached_index") && extra["narrow_cached_index"].cast<bool>()) {
+        // Only usable with the extraction functions, as the other functions assume the default cached types.
+        auto optr = new tatami_python::UnknownMatrix<double, std::int32_t, double, std::uint8_t>(std::move(seed), opt);
+        return reinterpret_cast<std::uintptr_t>(static_cast<void*>(static_cast<TestMatrix*>(optr)));
+    }
     auto optr = new tatami_python::UnknownMatrix<double, std::int32_t>(std::move(seed), opt);
     return reinterpret_cast<std::uintptr_t>(static_cast<void*>(static_cast<TestMatrix*>(optr)));
 }
 
+/*******************
+ *** Translation ***
+ *******************/
+
+typedef tatami_python::DelayedTranslation<double, std::int32_t> TestTranslation;
+
+std::uintptr_t translate_test(pybind11::object seed, double cache_size, bool require_min, const pybind11::dict& extra) {
+    auto opt = parse_options(cache_size, require_min, extra);
+    auto optr = new TestTranslation(tatami_python::translate_delayed<double, std::int32_t>(seed, opt));
+    return reinterpret_cast<std::uintptr_t>(optr);
+}
+
+void free_translated_test(const std::uintptr_t ptr0) {
+    delete reinterpret_cast<TestTranslation*>(ptr0);
+}
+
+std::uintptr_t translated_matrix_test(const std::uintptr_t ptr0) {
+    // Borrowed pointer that is only valid while the translation is alive.
+    const auto ptr = reinterpret_cast<TestTranslation*>(ptr0);
+    return reinterpret_cast<std::uintptr_t>(static_cast<const void*>(ptr->matrix.get()));
+}
+
+bool has_hdf5_test() {
+#ifdef TATAMI_PYTHON_USE_HDF5
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool free_threaded_test() {
+#ifdef TATAMI_PYTHON_PARALLELIZE_UNKNOWN
+    return tatami_python::gil_disabled();
+#else
+    return false;
+#endif
+}
+
+pybind11::dict translation_stats_test(const std::uintptr_t ptr0) {
+    const auto ptr = reinterpret_cast<TestTranslation*>(ptr0);
+    pybind11::dict output;
+    output["native_operations"] = ptr->native_operations;
+    output["native_seeds"] = ptr->native_seeds;
+    output["unknown_leaves"] = ptr->unknown_leaves;
+    return output;
+}
+
 int nrow_test(std::uintptr_t ptr0) {
     return reinterpret_cast<TestMatrix*>(ptr0)->nrow();
 }
@@ -38,6 +199,10 @@ bool prefer_rows_test(std::uintptr_t ptr0) {
     return reinterpret_cast<TestMatrix*>(ptr0)->prefer_rows();
 }
 
+double prefer_rows_proportion_test(std::uintptr_t ptr0) {
+    return reinterpret_cast<TestMatrix*>(ptr0)->prefer_rows_proportion();
+}
+
 bool is_sparse_test(std::uintptr_t ptr0) {
     return reinterpret_cast<TestMatrix*>(ptr0)->is_sparse();
 }
@@ -647,12 +812,170 @@ pybind11::array_t<double> oracular_sparse_sums(
     return sparse_sums<true>(ptr0, row, num_threads);
 }
 
+/******************
+ *** Partitions ***
+ ******************/
+
+typedef tatami_python::UnknownMatrix<double, std::int32_t> TestUnknownMatrix;
+
+pybind11::array_t<std::int32_t> chunk_ticks_test(const std::uintptr_t ptr0, const bool row) {
+    const auto ptr = dynamic_cast<const TestUnknownMatrix*>(reinterpret_cast<TestMatrix*>(ptr0));
+    const auto& ticks = ptr->chunk_ticks(row);
+    return pybind11::array_t<std::int32_t>(ticks.size(), ticks.data());
+}
+
+pybind11::dict statistics_test(const std::uintptr_t ptr0) {
+    const auto ptr = dynamic_cast<const TestUnknownMatrix*>(reinterpret_cast<TestMatrix*>(ptr0));
+    const auto stats = ptr->statistics();
+    pybind11::dict output;
+    output["chunk_loads"] = stats.chunk_loads;
+    output["element_loads"] = stats.element_loads;
+    output["switches_to_element"] = stats.switches_to_element;
+    output["switches_to_chunk"] = stats.switches_to_chunk;
+    output["switches_to_read_ahead"] = stats.switches_to_read_ahead;
+    output["current_memory"] = stats.current_memory;
+    output["peak_memory"] = stats.peak_memory;
+    return output;
+}
+
+void reset_peak_memory_test(const std::uintptr_t ptr0) {
+    const auto ptr = dynamic_cast<const TestUnknownMatrix*>(reinterpret_cast<TestMatrix*>(ptr0));
+    ptr->reset_peak_memory();
+}
+
+pybind11::dict access_trace_test(const std::uintptr_t ptr0) {
+    const auto ptr = dynamic_cast<const TestUnknownMatrix*>(reinterpret_cast<TestMatrix*>(ptr0));
+    const auto records = ptr->access_trace();
+    pybind11::list row, chunk, bytes, extractor, read_ahead;
+    for (const auto& rec : records) {
+        row.append(rec.row);
+        chunk.append(rec.chunk);
+        bytes.append(rec.bytes);
+        extractor.append(rec.extractor);
+        read_ahead.append(rec.read_ahead);
+    }
+    pybind11::dict output;
+    output["row"] = row;
+    output["chunk"] = chunk;
+    output["bytes"] = bytes;
+    output["extractor"] = extractor;
+    output["read_ahead"] = read_ahead;
+    return output;
+}
+
+void write_access_trace_test(const std::uintptr_t ptr0, const std::string& path) {
+    const auto ptr = dynamic_cast<const TestUnknownMatrix*>(reinterpret_cast<TestMatrix*>(ptr0));
+    std::ofstream output(path);
+    tatami_python::write_access_trace(ptr->access_trace(), output);
+}
+
+void clear_access_trace_test(const std::uintptr_t ptr0) {
+    const auto ptr = dynamic_cast<const TestUnknownMatrix*>(reinterpret_cast<TestMatrix*>(ptr0));
+    ptr->clear_access_trace();
+}
+
+// Replays a trace of chunk IDs against the myopic slab cache, returning the number of misses.
+std::size_t replay_cache_policy(const std::string& policy, const std::size_t max_slabs, const pybind11::array_t<std::int32_t>& trace) {
+    tatami_python::PolicySlabCache<std::int32_t, std::int32_t> cache(parse_cache_policy(policy), max_slabs);
+    const auto tptr = static_cast<const std::int32_t*>(trace.request().ptr);
+    std::size_t misses = 0;
+    for (pybind11::ssize_t i = 0, end = trace.size(); i < end; ++i) {
+        const auto& slab = cache.find(
+            tptr[i],
+            []() -> std::int32_t {
+                return -1;
+            },
+            [&](const std::int32_t id, std::int32_t& contents) -> void {
+                contents = id;
+                ++misses;
+            }
+        );
+        if (slab != tptr[i]) {
+            throw std::runtime_error("cache returned the wrong slab");
+        }
+    }
+    return misses;
+}
+
+pybind11::tuple chunk_lookup_test(const pybind11::array_t<std::int32_t>& ticks) {
+    const auto tptr = static_cast<const std::int32_t*>(ticks.request().ptr);
+    std::vector<std::int32_t> copy(tptr, tptr + ticks.size());
+    tatami_python::ChunkLookup<std::int32_t> lookup(copy);
+
+    const std::int32_t extent = (copy.empty() ? 0 : copy.back());
+    pybind11::array_t<std::int32_t> output(extent);
+    auto optr = static_cast<std::int32_t*>(output.request().ptr);
+    for (std::int32_t i = 0; i < extent; ++i) {
+        optr[i] = lookup[i];
+    }
+    return pybind11::make_tuple(lookup.is_regular(), output);
+}
+
+pybind11::array_t<std::int32_t> partition_test(const std::uintptr_t ptr0, const bool row, const int num_threads, const pybind11::array_t<double>& costs) {
+    const auto ptr = dynamic_cast<const TestUnknownMatrix*>(reinterpret_cast<TestMatrix*>(ptr0));
+    const double* cptr = NULL;
+    if (costs.size()) {
+        cptr = static_cast<const double*>(costs.request().ptr);
+    }
+    auto boundaries = tatami_python::partition_chunks(ptr->chunk_ticks(row), num_threads, cptr);
+    return pybind11::array_t<std::int32_t>(boundaries.size(), boundaries.data());
+}
+
+pybind11::array_t<double> aligned_dense_sums(
+    const std::uintptr_t ptr0,
+    const bool row,
+    [[maybe_unused]] const std::int32_t num_threads,
+    [[maybe_unused]] const bool stealing
+) {
+    const auto ptr = dynamic_cast<const TestUnknownMatrix*>(reinterpret_cast<TestMatrix*>(ptr0));
+    const auto primary = (row ? ptr->nrow() : ptr->ncol());
+    const auto secondary = (!row ? ptr->nrow() : ptr->ncol());
+    pybind11::array_t<double> output(primary);
+    auto optr = static_cast<double*>(output.request().ptr);
+
+    auto run = [&](const std::int32_t start, const std::int32_t len) -> void {
+        auto ext = tatami::new_extractor<false, true>(*ptr, row, std::make_shared<tatami::ConsecutiveOracle<std::int32_t> >(start, len));
+        std::vector<double> buffer(secondary);
+        for (std::int32_t i = 0; i < len; ++i) {
+            auto iptr = ext->fetch(buffer.data());
+            optr[i + start] = std::accumulate(iptr, iptr + secondary, 0.0);
+        }
+    };
+
+#ifdef TEST_CUSTOM_PARALLEL
+    if (stealing) {
+        tatami_python::parallelize_stealing([&](int, std::int32_t start, std::int32_t len) -> void {
+            run(start, len);
+        }, ptr->chunk_ticks(row), num_threads, 2);
+    } else {
+        tatami_python::parallelize_chunks([&](int, std::int32_t start, std::int32_t len) -> void {
+            run(start, len);
+        }, ptr->chunk_ticks(row), num_threads);
+    }
+#else
+    run(0, primary);
+#endif
+
+    return output;
+}
+
 PYBIND11_MODULE(lib_tatami_python_test, m) {
     m.def("free_test", &free_test);
+    m.def("translate_test", &translate_test);
+    m.def("free_translated_test", &free_translated_test);
+    m.def("translated_matrix_test", &translated_matrix_test);
+    m.def("translation_stats_test", &translation_stats_test);
+    m.def("has_hdf5_test", &has_hdf5_test);
+    m.def("free_threaded_test", &free_threaded_test);
+    m.def("create_cache_budget", &create_cache_budget);
+    m.def("free_cache_budget", &free_cache_budget);
+    m.def("cache_budget_stats", &cache_budget_stats);
+    m.def("reserved_by_extractor", &reserved_by_extractor);
     m.def("parse_test", &parse_test);
     m.def("nrow_test", &nrow_test);
     m.def("ncol_test", &ncol_test);
     m.def("prefer_rows_test", &prefer_rows_test);
+    m.def("prefer_rows_proportion_test", &prefer_rows_proportion_test);
     m.def("is_sparse_test", &is_sparse_test);
 
     m.def("myopic_dense_full", &myopic_dense_full);
@@ -673,4 +996,15 @@ PYBIND11_MODULE(lib_tatami_python_test, m) {
     m.def("oracular_dense_sums", &oracular_dense_sums);
     m.def("myopic_sparse_sums", &myopic_sparse_sums);
     m.def("oracular_sparse_sums", &oracular_sparse_sums);
+
+    m.def("chunk_ticks_test", &chunk_ticks_test);
+    m.def("statistics_test", &statistics_test);
+    m.def("reset_peak_memory_test", &reset_peak_memory_test);
+    m.def("access_trace_test", &access_trace_test);
+    m.def("write_access_trace_test", &write_access_trace_test);
+    m.def("clear_access_trace_test", &clear_access_trace_test);
+    m.def("replay_cache_policy", &replay_cache_policy);
+    m.def("chunk_lookup_test", &chunk_lookup_test);
+    m.def("partition_test", &partition_test);
+    m.def("aligned_dense_sums", &aligned_dense_sums);
 }
@@ -0,0 +1,65 @@
+import asyncio
+import threading
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+class EventLoopThread:
+    """Runs an asyncio event loop in a dedicated thread, for use as the
+    ``event_loop`` option of an ``UnknownMatrix``. This can be used as a
+    context manager, in which case the loop is stopped on exit.
+    """
+
+    def __init__(self):
+        self.loop = asyncio.new_event_loop()
+        self._thread = threading.Thread(target=self._run, daemon=True)
+        self._thread.start()
+
+
+    def _run(self):
+        asyncio.set_event_loop(self.loop)
+        self.loop.run_forever()
+
+
+    def close(self):
+        if self.loop.is_closed():
+            return
+        self.loop.call_soon_threadsafe(self.loop.stop)
+        self._thread.join()
+        self.loop.close()
+
+
+    def __enter__(self):
+        return self
+
+
+    def __exit__(self, *args):
+        self.close()
+
+
+class AsyncLatencyExtractor:
+    """Asynchronous stand-in for a storage layer with a fixed latency per
+    request. This wraps a synchronous extraction function like
+    ``delayedarray.extract_dense_array`` and records the maximum number of
+    requests that were outstanding at any one time.
+    """
+
+    def __init__(self, fun, latency = 0.001):
+        self._fun = fun
+        self._latency = latency
+        self.num_calls = 0
+        self.outstanding = 0
+        self.max_outstanding = 0
+
+
+    async def __call__(self, matrix, indices):
+        self.num_calls += 1
+        self.outstanding += 1
+        self.max_outstanding = max(self.max_outstanding, self.outstanding)
+        try:
+            await asyncio.sleep(self._latency)
+            return self._fun(matrix, indices)
+        finally:
+            self.outstanding -= 1
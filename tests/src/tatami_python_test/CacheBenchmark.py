@@ -0,0 +1,33 @@
+import numpy
+from . import lib_tatami_python_test as lib
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+def replay_cache_policy(policy, max_slabs, trace):
+    """Replay a trace of chunk IDs against the slab cache used by myopic
+    extractors, with the specified eviction policy (``"lru"``, ``"2q"`` or
+    ``"lfu"``) and capacity. Returns the number of cache misses, i.e., the
+    number of Python calls that would be made to populate the cache.
+    """
+    trace = numpy.array(trace, dtype=numpy.dtype("int32"))
+    return lib.replay_cache_policy(policy, max_slabs, trace)
+
+
+def compare_cache_policies(trace, capacities, policies = ("lru", "2q", "lfu")):
+    """Compare the hit rates of different eviction policies on a trace of
+    chunk IDs, e.g., as recorded from a real workload. Returns a dictionary
+    where each key is a policy and each value is a list of hit rates, one per
+    entry of ``capacities``.
+    """
+    trace = numpy.array(trace, dtype=numpy.dtype("int32"))
+    output = {}
+    for p in policies:
+        rates = []
+        for c in capacities:
+            misses = lib.replay_cache_policy(p, c, trace)
+            rates.append(1 - misses / len(trace) if len(trace) else 1)
+        output[p] = rates
+    return output
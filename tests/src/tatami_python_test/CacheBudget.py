@@ -0,0 +1,28 @@
+from . import lib_tatami_python_test as lib
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+class CacheBudget:
+    """Cache budget to be shared across multiple ``WrappedMatrix`` instances,
+    by passing it as the ``cache_budget`` option.
+    """
+
+    def __init__(self, total, expected_extractors = 1):
+        self._ptr = lib.create_cache_budget(total, expected_extractors)
+
+
+    def __del__(self):
+        lib.free_cache_budget(self._ptr)
+
+
+    def statistics(self):
+        return lib.cache_budget_stats(self._ptr)
+
+
+    def reserved_by_extractor(self, matrix, row):
+        """Number of bytes reserved while a single dense extractor for
+        ``matrix``, a ``WrappedMatrix`` using this budget, is alive."""
+        return lib.reserved_by_extractor(matrix._ptr, self._ptr, row)
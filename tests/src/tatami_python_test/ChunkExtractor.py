@@ -0,0 +1,49 @@
+import numpy
+import delayedarray
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+class ChunkExtractor:
+    """Reference implementation of the chunk extraction protocol of
+    ``UnknownMatrix``, built on top of ``delayedarray.extract_dense_array``
+    or ``delayedarray.extract_sparse_array``. If ``concatenate = True``, a
+    single result is returned for all ranges, otherwise one result is
+    returned per range. The number of ranges that were requested is recorded
+    in ``num_ranges``, and the largest total length of the ranges in a single
+    call is recorded in ``max_length``.
+    """
+
+    def __init__(self, sparse = False, concatenate = False):
+        if sparse:
+            self._fun = delayedarray.extract_sparse_array
+        else:
+            self._fun = delayedarray.extract_dense_array
+        self._concatenate = concatenate
+        self.num_calls = 0
+        self.num_ranges = 0
+        self.max_length = 0
+
+
+    def _create_subset(self, target, non_target, axis):
+        if axis == 0:
+            return (target, non_target)
+        else:
+            return (non_target, target)
+
+
+    def __call__(self, matrix, ranges, non_target, axis):
+        self.num_calls += 1
+        self.num_ranges += len(ranges)
+        self.max_length = max(self.max_length, sum(length for _, length in ranges))
+
+        if self._concatenate:
+            target = numpy.concatenate([numpy.arange(start, start + length) for start, length in ranges])
+            return self._fun(matrix, self._create_subset(target, non_target, axis))
+
+        output = []
+        for start, length in ranges:
+            output.append(self._fun(matrix, self._create_subset(range(start, start + length), non_target, axis)))
+        return output
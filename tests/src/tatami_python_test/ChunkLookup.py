@@ -0,0 +1,16 @@
+import numpy
+from . import lib_tatami_python_test as lib
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+def chunk_lookup(ticks):
+    """Build the ``ChunkLookup`` used by ``UnknownMatrix`` from the chunk
+    boundaries in ``ticks``, which should start at zero and end at the extent
+    of the dimension. Returns a tuple containing whether the grid was treated
+    as regular, and the index of the chunk containing each row/column.
+    """
+    ticks = numpy.array(ticks, dtype=numpy.dtype("int32"))
+    return lib.chunk_lookup_test(ticks)
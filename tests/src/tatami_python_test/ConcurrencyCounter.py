@@ -0,0 +1,43 @@
+import time
+import threading
+from . import lib_tatami_python_test as lib
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+def is_free_threaded():
+    """Whether the GIL is disabled and the test library was compiled to
+    parallelize ``UnknownMatrix`` extraction, i.e., whether the
+    ``thread_safe`` option can actually allow concurrent calls.
+    """
+    return lib.free_threaded_test()
+
+
+class ConcurrencyCounter:
+    """Wraps an extraction function like ``delayedarray.extract_dense_array``
+    with a short delay per call, and records the maximum number of calls
+    that were executing at the same time.
+    """
+
+    def __init__(self, fun, latency = 0.005):
+        self._fun = fun
+        self._latency = latency
+        self._lock = threading.Lock()
+        self._current = 0
+        self.max_concurrent = 0
+        self.num_calls = 0
+
+
+    def __call__(self, matrix, indices):
+        with self._lock:
+            self._current += 1
+            self.num_calls += 1
+            self.max_concurrent = max(self.max_concurrent, self._current)
+        try:
+            time.sleep(self._latency)
+            return self._fun(matrix, indices)
+        finally:
+            with self._lock:
+                self._current -= 1
@@ -0,0 +1,35 @@
+import delayedarray
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+class OutExtractor:
+    """Replacement for ``delayedarray.extract_dense_array`` that supports the
+    ``out=`` protocol of ``UnknownMatrix``, by filling the supplied array in
+    place. The number of calls that used ``out=`` is recorded in ``num_out``,
+    and the size of the largest ``out=`` array is recorded in ``max_out_size``.
+    If ``fail`` is true, a ``TypeError`` is raised whenever ``out=`` is used,
+    to check that errors from the backend are not mistaken for a lack of
+    support for ``out=``.
+    """
+
+    def __init__(self, fail = False):
+        self.num_out = 0
+        self.max_out_size = 0
+        self._fail = fail
+
+
+    def __call__(self, matrix, indices, out = None):
+        res = delayedarray.extract_dense_array(matrix, indices)
+        if out is None:
+            return res
+        if self._fail:
+            raise TypeError("failed to fill 'out'")
+        assert out.shape == res.shape
+        assert out.flags.writeable
+        out[...] = res
+        self.num_out += 1
+        self.max_out_size = max(self.max_out_size, out.size)
+        return out
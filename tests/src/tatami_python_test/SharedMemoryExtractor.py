@@ -0,0 +1,127 @@
+import numpy
+import weakref
+import threading
+import delayedarray
+import multiprocessing
+from multiprocessing import shared_memory
+from concurrent.futures import ProcessPoolExecutor, wait
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+_worker_matrix = None
+
+
+def _initialize_worker(matrix):
+    global _worker_matrix
+    _worker_matrix = matrix
+
+
+def _noop():
+    return None
+
+
+def _extract_into_shared_memory(name, shape, dtype, start, end, indices):
+    # Each worker fills a contiguous range of rows of the C-contiguous output.
+    # The matrix is supplied by the initializer so that it is not pickled for every request.
+    shm = shared_memory.SharedMemory(name=name)
+    try:
+        out = numpy.ndarray(shape, dtype=dtype, buffer=shm.buf)
+        out[start:end,:] = delayedarray.extract_dense_array(_worker_matrix, (indices[0][start:end], indices[1]))
+        del out
+    finally:
+        shm.close()
+    return end - start
+
+
+class SharedMemoryExtractor:
+    """Replacement for ``delayedarray.extract_dense_array`` that distributes
+    each request across a pool of worker processes. Workers write directly
+    into a shared memory block that is returned to the caller as a NumPy
+    array without any copy. This is intended for use as the
+    ``dense_extractor`` option of an ``UnknownMatrix`` when the backend holds
+    the GIL, such that a single interpreter would serialize all extraction.
+
+    This is a test helper that only supports dense extraction. The matrix
+    must be picklable, as workers are started with the ``forkserver`` (or
+    ``spawn``) method; forking is unsafe as requests may be issued from
+    threads created by ``tatami::parallelize()``. All workers are started in
+    the constructor, before any extraction takes place. Shared memory blocks
+    are re-used once the caller has released the array for a previous request.
+    """
+
+    def __init__(self, matrix, num_workers = 2):
+        self._dtype = numpy.dtype(matrix.dtype)
+        self._num_workers = num_workers
+
+        methods = multiprocessing.get_all_start_methods()
+        context = multiprocessing.get_context("forkserver" if "forkserver" in methods else "spawn")
+        self._pool = ProcessPoolExecutor(
+            max_workers=num_workers,
+            mp_context=context,
+            initializer=_initialize_worker,
+            initargs=(matrix,)
+        )
+        wait([self._pool.submit(_noop) for w in range(num_workers)])
+
+        self._lock = threading.Lock()
+        self._blocks = []
+        self.num_calls = 0
+        self.num_blocks_created = 0
+
+
+    def _acquire(self, nbytes):
+        # A block can be re-used once the array returned for its last request (and all views thereof) has been garbage-collected.
+        for entry in self._blocks:
+            if entry[1] is not None and entry[1]() is not None:
+                continue
+            if entry[0].size >= nbytes:
+                return entry
+        entry = [shared_memory.SharedMemory(create=True, size=nbytes), None]
+        self._blocks.append(entry)
+        self.num_blocks_created += 1
+        return entry
+
+
+    def __call__(self, matrix, indices):
+        indices = (numpy.asarray(indices[0]), numpy.asarray(indices[1]))
+        shape = (len(indices[0]), len(indices[1]))
+        nbytes = max(1, shape[0] * shape[1] * self._dtype.itemsize)
+
+        with self._lock:
+            self.num_calls += 1
+            entry = self._acquire(nbytes)
+            output = numpy.ndarray(shape, dtype=self._dtype, buffer=entry[0].buf)
+            entry[1] = weakref.ref(output)
+
+        shm = entry[0]
+        nworkers = min(self._num_workers, shape[0])
+        futures = []
+        for w in range(nworkers):
+            start = (shape[0] * w) // nworkers
+            end = (shape[0] * (w + 1)) // nworkers
+            futures.append(self._pool.submit(_extract_into_shared_memory, shm.name, shape, self._dtype, start, end, indices))
+        for f in futures:
+            f.result()
+
+        return output
+
+
+    def close(self):
+        if getattr(self, "_pool", None) is None:
+            return
+        self._pool.shutdown()
+        self._pool = None
+        for entry in self._blocks:
+            try:
+                entry[0].close()
+            except BufferError:
+                pass # caller is still holding onto an array view, so the mapping will be released when it is garbage-collected.
+            entry[0].unlink()
+        self._blocks = []
+
+
+    def __del__(self):
+        self.close()
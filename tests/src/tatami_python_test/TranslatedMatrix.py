@@ -0,0 +1,30 @@
+from . import lib_tatami_python_test as lib
+from .WrappedMatrix import WrappedMatrix
+
+__author__ = "ltla"
+__copyright__ = "ltla"
+__license__ = "MIT"
+
+
+class TranslatedMatrix(WrappedMatrix):
+    """``DelayedArray`` that is translated into native **tatami** operations,
+    with ``WrappedMatrix`` leaves for any unsupported operations or seeds.
+    Only the extraction methods are supported.
+    """
+
+    def __init__(self, obj, cache_size = 1e8, require_cache = True, **kwargs):
+        self._holder = lib.translate_test(obj, cache_size, require_cache, kwargs)
+        self._ptr = lib.translated_matrix_test(self._holder)
+
+
+    def __del__(self):
+        lib.free_translated_test(self._holder)
+
+
+    def translation_statistics(self):
+        return lib.translation_stats_test(self._holder)
+
+
+    @staticmethod
+    def has_hdf5():
+        return lib.has_hdf5_test()
@@ -8,8 +8,11 @@ __license__ = "MIT"
 
 
 class WrappedMatrix:
-    def __init__(self, obj, cache_size = 1e8, require_cache = True):
-        self._ptr = lib.parse_test(obj, cache_size, require_cache)
+    def __init__(self, obj, cache_size = 1e8, require_cache = True, **kwargs):
+        if "cache_budget" in kwargs:
+            # The matrix holds its own reference to the budget, so the Python object doesn't need to outlive it.
+            kwargs["cache_budget"] = kwargs["cache_budget"]._ptr
+        self._ptr = lib.parse_test(obj, cache_size, require_cache, kwargs)
 
 
     def __del__(self):
@@ -28,6 +31,10 @@ class WrappedMatrix:
         return lib.prefer_rows_test(self._ptr);
 
 
+    def prefer_rows_proportion(self):
+        return lib.prefer_rows_proportion_test(self._ptr);
+
+
     def is_sparse(self):
         return lib.is_sparse_test(self._ptr);
 
@@ -84,3 +91,39 @@ class WrappedMatrix:
             return lib.oracular_sparse_sums(self._ptr, row, num_threads)
         else:
             return lib.myopic_sparse_sums(self._ptr, row, num_threads)
+
+
+    def chunk_ticks(self, row):
+        return lib.chunk_ticks_test(self._ptr, row)
+
+
+    def statistics(self):
+        return lib.statistics_test(self._ptr)
+
+
+    def reset_peak_memory(self):
+        lib.reset_peak_memory_test(self._ptr)
+
+
+    def access_trace(self):
+        return lib.access_trace_test(self._ptr)
+
+
+    def clear_access_trace(self):
+        lib.clear_access_trace_test(self._ptr)
+
+
+    def write_access_trace(self, path):
+        lib.write_access_trace_test(self._ptr, path)
+
+
+    def partition(self, row, num_threads, costs = None):
+        if costs is None:
+            costs = numpy.zeros(0, dtype=numpy.dtype("double"))
+        else:
+            costs = numpy.array(costs, dtype=numpy.dtype("double"))
+        return lib.partition_test(self._ptr, row, num_threads, costs)
+
+
+    def aligned_dense_sum(self, row, num_threads, stealing = False):
+        return lib.aligned_dense_sums(self._ptr, row, num_threads, stealing)
@@ -17,3 +17,12 @@ finally:
 
 
 from .WrappedMatrix import WrappedMatrix
+from .SharedMemoryExtractor import SharedMemoryExtractor
+from .AsyncLatencyExtractor import AsyncLatencyExtractor, EventLoopThread
+from .OutExtractor import OutExtractor
+from .ChunkExtractor import ChunkExtractor
+from .ChunkLookup import chunk_lookup
+from .CacheBenchmark import replay_cache_policy, compare_cache_policies
+from .CacheBudget import CacheBudget
+from .TranslatedMatrix import TranslatedMatrix
+from .ConcurrencyCounter import ConcurrencyCounter, is_free_threaded
@@ -1,9 +1,19 @@
 import numpy
 import delayedarray
 import random
+import importlib.util
+import os
 import tatami_python_test
 
 
+def load_cache_advisor():
+    path = os.path.join(os.path.dirname(__file__), "..", "..", "tools", "cache_advisor.py")
+    spec = importlib.util.spec_from_file_location("cache_advisor", path)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module
+
+
 def get_cache_size(mat, cache_fraction, sparse):
     if sparse:
         # For dense, cache value is always double. In theory, we could
@@ -87,6 +97,28 @@ def compare_list_of_vectors(x, y):
         assert (x[i] == y[i]).all()
 
 
+def reference_sums(mat):
+    # Indexed by 'int(row)', i.e., the row sums are in the second entry.
+    extracted = delayedarray.extract_dense_array(mat, (range(mat.shape[0]), range(mat.shape[1])))
+    return [extracted.sum(axis=0), extracted.sum(axis=1)]
+
+
+def check_sums(mat, dense=(), sparse=(), **kwargs):
+    # Each entry of 'dense' and 'sparse' should be a (row, oracle, num_threads) tuple.
+    # All other arguments are passed to the WrappedMatrix, which is returned for further checks.
+    refs = reference_sums(mat)
+    ptr = tatami_python_test.WrappedMatrix(mat, **kwargs)
+    for row, oracle, num_threads in dense:
+        assert numpy.allclose(refs[int(row)], ptr.dense_sum(row, oracle, num_threads))
+    for row, oracle, num_threads in sparse:
+        assert numpy.allclose(refs[int(row)], ptr.sparse_sum(row, oracle, num_threads))
+    return ptr
+
+
+def max_chunk_length(ticks):
+    return max([ticks[i] - ticks[i - 1] for i in range(1, len(ticks))], default=0)
+
+
 def quick_test_suite(subtests, mat):
     # Quick tests, mostly to verify that the functions work with other types.
     ptr = tatami_python_test.WrappedMatrix(mat, 10000, True)
@@ -349,6 +381,67 @@ def parallel_test_suite(subtests, mat):
             assert numpy.allclose(refc, ptr.sparse_sum(False, True, 3))
             assert numpy.allclose(refc, ptr.sparse_sum(False, False, 3))
 
+        with subtests.test(msg="thread-safe sums", cache=cache):
+            # This only has an effect on free-threaded builds, but we test it anyway.
+            cache_size = get_cache_size(mat, cache, False)
+            check_sums(
+                mat,
+                dense=[(True, True, 3), (False, False, 3)],
+                sparse=[(True, False, 3), (False, True, 3)],
+                cache_size=cache_size,
+                require_cache=cache_size > 0,
+                thread_safe=True
+            )
+
+    for thread_safe in [False, True]:
+        with subtests.test(msg="free-threaded sums", thread_safe=thread_safe):
+            dext = tatami_python_test.ConcurrencyCounter(delayedarray.extract_dense_array)
+            sext = tatami_python_test.ConcurrencyCounter(delayedarray.extract_sparse_array)
+            check_sums(
+                mat,
+                dense=[(True, False, 3)],
+                sparse=[(True, False, 3)],
+                cache_size=0,
+                require_cache=False,
+                thread_safe=thread_safe,
+                dense_extractor=dext,
+                sparse_extractor=sext
+            )
+
+            # Calls are only concurrent if the backend is declared to be thread-safe and the GIL is disabled.
+            if thread_safe and tatami_python_test.is_free_threaded():
+                if mat.shape[0] >= 3 and mat.shape[1] > 0:
+                    assert max(dext.max_concurrent, sext.max_concurrent) > 1
+            else:
+                assert dext.max_concurrent <= 1
+                assert sext.max_concurrent <= 1
+
+
+def translate_test_suite(subtests, x, sparse):
+    # Returns the translation statistics so that callers can check which parts were translated.
+    expected_mat = delayedarray.to_dense_array(x)
+    ptr = tatami_python_test.TranslatedMatrix(x)
+    assert ptr.nrow() == x.shape[0]
+    assert ptr.ncol() == x.shape[1]
+
+    for row in [True, False]:
+        for oracle in [False, True]:
+            with subtests.test(msg="translated", row=row, oracle=oracle, sparse=sparse):
+                iseq = create_predictions(x.shape[1 - int(row)], 1, "forward")
+                all_expected = create_expected_dense(expected_mat, row, iseq, None)
+                extracted = ptr.extract_dense(row, iseq, None, oracle)
+                compare_list_of_vectors(extracted, all_expected)
+
+                extracted_sparse = ptr.extract_sparse(row, iseq, None, oracle)
+                compare_list_of_vectors(fill_sparse(extracted_sparse, x.shape[int(row)], None), all_expected)
+
+                keep = list(range(0, x.shape[int(row)], 3))
+                all_expected = create_expected_dense(expected_mat, row, iseq, keep)
+                extracted = ptr.extract_dense(row, iseq, keep, oracle)
+                compare_list_of_vectors(extracted, all_expected)
+
+    return ptr.translation_statistics()
+
 
 def big_test_suite(subtests, mat):
     full_test_suite(subtests, mat)
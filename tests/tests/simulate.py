@@ -108,3 +108,18 @@ def extract_array_from_IrregularChunkedArray(x: IrregularChunkedArray, indices):
 @delayedarray.chunk_grid.register
 def chunk_grid_from_IrregularChunkedArray(x: IrregularChunkedArray):
     return delayedarray.SimpleGrid(x._ticks, cost_factor=1)
+
+
+def feature_matrices():
+    # Representative matrices for the tests of optional features,
+    # which don't need to be repeated across every layout in the main test files.
+    return {
+        "dense": numpy.random.rand(34, 82),
+        "dense regular": RegularChunkedArray(numpy.random.rand(54, 92), (10, 10)),
+        "dense irregular": IrregularChunkedArray(numpy.random.rand(77, 88), (create_irregular_ticks(77, 0.2), create_irregular_ticks(88, 0.1))),
+        "sparse": simulate_sparse(34, 82),
+        "sparse regular": RegularChunkedArray(simulate_sparse(124, 52), (10, 10)),
+        "sparse irregular": IrregularChunkedArray(simulate_sparse(97, 78), (create_irregular_ticks(97, 0.1), create_irregular_ticks(78, 0.15))),
+        "no rows": numpy.random.rand(0, 10),
+        "no columns": numpy.random.rand(10, 0),
+    }
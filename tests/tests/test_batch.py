@@ -0,0 +1,59 @@
+import pytest
+import tatami_python_test
+import compare
+import simulate
+
+MATRICES = simulate.feature_matrices()
+
+
+def count_calls(mat, sums, **kwargs):
+    # Number of calls to the chunk extractors when computing the dense and sparse sums.
+    dext = tatami_python_test.ChunkExtractor(sparse=False)
+    sext = tatami_python_test.ChunkExtractor(sparse=True)
+    ptr = compare.check_sums(mat, dense=sums, sparse=sums, dense_chunk_extractor=dext, sparse_chunk_extractor=sext, **kwargs)
+    return ptr, dext, sext
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_batch_elements(subtests, mat):
+    for row in [True, False]:
+        otherdim = mat.shape[int(row)]
+        ticks = tatami_python_test.WrappedMatrix(mat).chunk_ticks(row)
+        num_chunks = len(ticks) - 1
+
+        with subtests.test(msg="maximum batch elements", row=row):
+            # Only one row/column per call, so each call should contain a single chunk.
+            ptr, dext, sext = count_calls(mat, [(row, True, 1), (row, True, 3)], maximum_batch_elements=max(otherdim, 1))
+            assert dext.num_ranges == dext.num_calls
+            assert sext.num_ranges == sext.num_calls
+
+        with subtests.test(msg="minimum batch elements", row=row):
+            # Enough to hold the entire matrix, even though the cache itself is tiny.
+            cache_size = compare.get_cache_size(mat, 0.01, True)
+            num_calls = []
+            for minimum in [0, mat.shape[0] * mat.shape[1]]:
+                ptr, dext, sext = count_calls(mat, [(row, True, 1)], cache_size=cache_size, minimum_batch_elements=minimum)
+                num_calls.append(dext.num_calls + sext.num_calls)
+
+            # The tiny cache can only hold one chunk, so each extraction needs one call per chunk without the minimum.
+            if num_chunks > 1 and otherdim > 0:
+                assert num_calls[1] < num_calls[0]
+            else:
+                assert num_calls[1] == num_calls[0]
+
+        with subtests.test(msg="minimum batch elements read-ahead", row=row):
+            # Room for a few chunks in each of the myopic and read-ahead caches, so that the read-ahead is enabled.
+            cache_size = 2 * 2 * compare.max_chunk_length(ticks) * otherdim * 12
+            num_calls = []
+            num_switches = []
+            for minimum in [0, mat.shape[0] * mat.shape[1]]:
+                ptr, dext, sext = count_calls(mat, [(row, False, 1)], cache_size=cache_size, sequential_read_ahead=True, minimum_batch_elements=minimum)
+                num_calls.append(dext.num_calls + sext.num_calls)
+                num_switches.append(ptr.statistics()["switches_to_read_ahead"])
+
+            # Once it kicks in, the read-ahead cache should hold all remaining chunks in a single batch.
+            assert num_switches[0] == num_switches[1]
+            if num_switches[0] > 0 and num_chunks > 4 and otherdim > 0:
+                assert num_calls[1] < num_calls[0]
+            else:
+                assert num_calls[1] <= num_calls[0]
@@ -0,0 +1,31 @@
+import os
+import tempfile
+import compare
+
+
+def test_cache_advisor_read_trace():
+    advisor = compare.load_cache_advisor()
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "trace.csv")
+        with open(path, "w") as handle:
+            handle.write("extractor,read_ahead,row,chunk,bytes\n")
+            handle.write("0,0,1,0,10\n")
+            handle.write("0,1,1,1,10\n")
+            handle.write("0,2,1,2,10\n")
+            handle.write("1,true,0,0,20\n")
+        traces = advisor.read_trace(path)
+
+    # Each read-ahead cache of the same extractor is replayed separately.
+    assert sorted(traces.keys()) == [(0, 0), (0, 1), (0, 2), (1, 1)]
+    assert traces[(0, 2)] == [((True, 2), 10)]
+    assert traces[(1, 1)] == [((False, 0), 20)]
+
+
+def test_cache_advisor_belady_batches():
+    advisor = compare.load_cache_advisor()
+    A, B, C, D = [(True, i) for i in range(4)]
+    trace = [(A, 1), (B, 1), (A, 1), (C, 1), (D, 1), (A, 1)]
+
+    # 'A' is retained for its last use, so the call for 'C' has no room to also load 'D'.
+    assert advisor.simulate_belady(trace, 2) == (4, 3)
+    assert advisor.simulate_belady(trace, 3) == (4, 2)
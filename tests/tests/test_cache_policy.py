@@ -0,0 +1,80 @@
+import numpy
+import pytest
+import random
+import tatami_python_test
+import compare
+
+
+def simulate_lru(max_slabs, trace):
+    cache = []
+    misses = 0
+    for x in trace:
+        if x in cache:
+            cache.remove(x)
+        else:
+            misses += 1
+            if len(cache) == max_slabs:
+                cache.pop(0)
+        cache.append(x)
+    return misses
+
+
+def create_scan_trace(num_rounds, hot, scan):
+    # Hot working set that is revisited between full sweeps over a larger set of chunks.
+    trace = []
+    for r in range(num_rounds):
+        for _ in range(3):
+            trace += hot
+        trace += scan
+    return trace
+
+
+def test_cache_policy_consistency():
+    trace = [random.randrange(50) for _ in range(2000)]
+    for max_slabs in [1, 5, 20, 60]:
+        assert tatami_python_test.replay_cache_policy("lru", max_slabs, trace) == simulate_lru(max_slabs, trace)
+
+        # All policies should only miss once per chunk if everything fits in the cache.
+        for policy in ["lru", "2q", "lfu"]:
+            misses = tatami_python_test.replay_cache_policy(policy, max_slabs, trace)
+            if max_slabs >= 50:
+                assert misses == 50
+            else:
+                assert misses >= 50
+
+    for policy in ["lru", "2q", "lfu"]:
+        assert tatami_python_test.replay_cache_policy(policy, 10, []) == 0
+
+    # There would be nothing to evict from an empty cache.
+    for policy in ["2q", "lfu"]:
+        with pytest.raises(RuntimeError, match="positive"):
+            tatami_python_test.replay_cache_policy(policy, 0, [1, 2])
+
+
+def test_cache_policy_scan_resistance():
+    trace = create_scan_trace(10, list(range(5)), list(range(100, 200)))
+    lru = tatami_python_test.replay_cache_policy("lru", 20, trace)
+    assert lru == 10 * 105
+
+    # Scan-resistant policies should keep the hot set in the cache across sweeps.
+    assert tatami_python_test.replay_cache_policy("2q", 20, trace) == 5 + 10 * 100
+    assert tatami_python_test.replay_cache_policy("lfu", 20, trace) == 5 + 10 * 100
+
+    rates = tatami_python_test.compare_cache_policies(trace, [10, 20, 200])
+    assert rates["lru"][1] < rates["2q"][1]
+    assert rates["lru"][1] < rates["lfu"][1]
+    for policy, r in rates.items():
+        assert r[2] == 1 - 105 / len(trace)
+
+
+def test_cache_policy_extraction(subtests):
+    mat = numpy.random.rand(50, 40)
+    for policy in ["2q", "lfu"]:
+        for row in [True, False]:
+            with subtests.test(msg="cache policy", policy=policy, row=row):
+                iterdim = mat.shape[1 - int(row)]
+                iseq = numpy.array([random.randrange(iterdim) for _ in range(200)], dtype=numpy.dtype("int32"))
+                all_expected = compare.create_expected_dense(mat, row, iseq, None)
+                cache_size = compare.get_cache_size(mat, 0.1, True)
+                ptr = tatami_python_test.WrappedMatrix(mat, cache_size, True, cache_policy=policy, sequential_read_ahead=False)
+                compare.compare_list_of_vectors(ptr.extract_dense(row, iseq, None), all_expected)
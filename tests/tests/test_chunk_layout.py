@@ -0,0 +1,79 @@
+import delayedarray
+import pytest
+import tatami_python_test
+import compare
+import simulate
+
+MATRICES = simulate.feature_matrices()
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_merge_chunks(subtests, mat):
+    element_size = 12 if delayedarray.is_sparse(mat) else 8
+    cache_size = int(compare.get_cache_size(mat, 0.2, False))
+    unmerged = tatami_python_test.WrappedMatrix(mat, cache_size, False)
+
+    for min_elements in [1, 100, 1000]:
+        for row in [True, False]:
+            with subtests.test(msg="merge chunks", min_elements=min_elements, row=row):
+                ptr = compare.check_sums(
+                    mat,
+                    dense=[(row, False, 1), (row, True, 1)],
+                    sparse=[(row, True, 1)],
+                    cache_size=cache_size,
+                    require_cache=False,
+                    minimum_chunk_elements=min_elements
+                )
+
+                ticks = list(ptr.chunk_ticks(row))
+                original = list(unmerged.chunk_ticks(row))
+                for t in ticks:
+                    assert t in original
+                assert len(ticks) <= len(original)
+
+                non_target = mat.shape[int(row)]
+                if non_target:
+                    max_length = cache_size // (element_size * non_target)
+                    for i in range(1, len(ticks) - 1):
+                        length = ticks[i] - ticks[i - 1]
+                        if length * non_target < min_elements:
+                            # Only allowed if the next chunk would have exceeded the cache.
+                            nxt = original[original.index(ticks[i]) + 1]
+                            assert nxt - ticks[i - 1] > max_length
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_split_chunks(subtests, mat):
+    element_size = 12 if delayedarray.is_sparse(mat) else 8
+    reference = tatami_python_test.WrappedMatrix(mat)
+
+    for cache in [0.01, 0.1]:
+        cache_size = int(compare.get_cache_size(mat, cache, False))
+        unsplit = tatami_python_test.WrappedMatrix(mat, cache_size, False)
+
+        for row in [True, False]:
+            with subtests.test(msg="split chunks", cache=cache, row=row):
+                ptr = compare.check_sums(
+                    mat,
+                    dense=[(row, False, 1), (row, True, 1)],
+                    sparse=[(row, True, 1)],
+                    cache_size=cache_size,
+                    require_cache=False,
+                    split_oversized_chunks=True
+                )
+
+                ticks = list(ptr.chunk_ticks(row))
+                original = list(unsplit.chunk_ticks(row))
+                for t in original:
+                    assert t in ticks
+
+                non_target = mat.shape[int(row)]
+                if non_target:
+                    max_length = max(1, cache_size // (element_size * non_target))
+                    for i in range(1, len(ticks)):
+                        assert ticks[i] - ticks[i - 1] <= max_length
+
+                # By default, chunks are not split, so partitioning for parallel iteration is still aligned to the storage chunks.
+                assert original == list(reference.chunk_ticks(row))
+                for b in unsplit.partition(row, 3):
+                    assert b in original
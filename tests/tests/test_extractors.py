@@ -0,0 +1,183 @@
+import concurrent.futures
+import delayedarray
+import pytest
+import tatami_python_test
+import compare
+import simulate
+
+MATRICES = simulate.feature_matrices()
+ALL_SUMS = [(row, oracle, 1) for row in [True, False] for oracle in [True, False]]
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_shared_memory_extractor(mat):
+    ext = tatami_python_test.SharedMemoryExtractor(mat, num_workers=2)
+    try:
+        # Using a plain counter as a reference for the expected number of calls.
+        ref = tatami_python_test.ConcurrencyCounter(delayedarray.extract_dense_array, latency=0)
+        ptr = compare.check_sums(mat, dense=[(True, True, 1), (False, True, 3)], dense_extractor=ext)
+        refptr = compare.check_sums(mat, dense=[(True, True, 1), (False, True, 3)], dense_extractor=ref)
+        assert ext.num_calls == ref.num_calls
+
+        # Values should be identical to the original backend for random access.
+        iseq = compare.create_predictions(mat.shape[1], 1, "random")
+        all_expected = compare.create_expected_dense(mat, False, iseq, None)
+        compare.compare_list_of_vectors(ptr.extract_dense(False, iseq, None, False), all_expected)
+        compare.compare_list_of_vectors(refptr.extract_dense(False, iseq, None, False), all_expected)
+        assert ext.num_calls == ref.num_calls
+
+        if mat.shape[0] and mat.shape[1] and not delayedarray.is_sparse(mat):
+            assert ext.num_calls > 0
+            # Blocks are re-used once the previous array has been released.
+            assert ext.num_blocks_created < ext.num_calls
+    finally:
+        ext.close()
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_executor(subtests, mat):
+    for max_in_flight in [1, 2, 5]:
+        with subtests.test(msg="executor", max_in_flight=max_in_flight):
+            with concurrent.futures.ThreadPoolExecutor(max_workers=3) as executor:
+                compare.check_sums(
+                    mat,
+                    dense=[(True, True, 1), (False, True, 3)],
+                    sparse=[(True, True, 3), (False, True, 1)],
+                    executor=executor,
+                    max_in_flight=max_in_flight
+                )
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_event_loop(subtests, mat):
+    for max_in_flight in [1, 4]:
+        with subtests.test(msg="event loop", max_in_flight=max_in_flight):
+            with tatami_python_test.EventLoopThread() as runner:
+                dext = tatami_python_test.AsyncLatencyExtractor(delayedarray.extract_dense_array)
+                sext = tatami_python_test.AsyncLatencyExtractor(delayedarray.extract_sparse_array)
+                ptr = compare.check_sums(
+                    mat,
+                    dense=[(True, True, 1)],
+                    dense_extractor=dext,
+                    sparse_extractor=sext,
+                    event_loop=runner.loop,
+                    max_in_flight=max_in_flight
+                )
+
+                # Each call awaits before returning, so calls for multiple chunks should overlap on the loop.
+                if max_in_flight > 1 and len(ptr.chunk_ticks(True)) > 2 and mat.shape[1] > 0:
+                    assert max(dext.max_outstanding, sext.max_outstanding) > 1
+                del ptr
+
+                compare.check_sums(
+                    mat,
+                    dense=[(False, False, 1)],
+                    sparse=[(True, True, 1), (False, False, 1)],
+                    dense_extractor=dext,
+                    sparse_extractor=sext,
+                    event_loop=runner.loop,
+                    max_in_flight=max_in_flight
+                )
+                assert max(dext.max_outstanding, sext.max_outstanding) <= max_in_flight
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_out(subtests, mat):
+    for cache in [0, 0.01, 0.1]:
+        cache_size = compare.get_cache_size(mat, cache, False)
+
+        with subtests.test(msg="out", cache=cache):
+            ext = tatami_python_test.OutExtractor()
+            compare.check_sums(mat, dense=ALL_SUMS, cache_size=cache_size, require_cache=cache_size > 0, dense_extractor=ext, use_out=True)
+            if cache > 0 and mat.shape[0] and mat.shape[1] and not delayedarray.is_sparse(mat):
+                assert ext.num_out > 0
+
+        with subtests.test(msg="out batch", cache=cache):
+            # Oracle-aware batches of multiple chunks should also be filled via 'out='.
+            for row in [True, False]:
+                ext = tatami_python_test.OutExtractor()
+                ptr = compare.check_sums(mat, dense=[(row, True, 1)], cache_size=cache_size, require_cache=cache_size > 0, dense_extractor=ext, use_out=True)
+
+                ticks = ptr.chunk_ticks(row)
+                otherdim = mat.shape[int(row)]
+                max_chunk = compare.max_chunk_length(ticks)
+                num_slabs = int(cache_size // (max_chunk * otherdim * 8)) if max_chunk * otherdim else 0
+                if min(num_slabs, len(ticks) - 1) >= 2 and not delayedarray.is_sparse(mat):
+                    assert ext.max_out_size > max_chunk * otherdim
+
+        with subtests.test(msg="out fallback", cache=cache):
+            # The default extract_dense_array() doesn't accept 'out=', so this should fall back to the usual extraction.
+            fallback_sums = [(True, False, 1), (False, True, 1)]
+            compare.check_sums(mat, dense=fallback_sums, cache_size=cache_size, require_cache=cache_size > 0, use_out=True)
+
+            # An explicit declaration overrides the signature.
+            ext = tatami_python_test.OutExtractor()
+            ext.supports_out = False
+            compare.check_sums(mat, dense=fallback_sums, cache_size=cache_size, require_cache=cache_size > 0, dense_extractor=ext, use_out=True)
+            assert ext.num_out == 0
+
+        with subtests.test(msg="out error", cache=cache):
+            # Errors from a backend that supports 'out=' should be propagated, even if they are TypeErrors.
+            ext = tatami_python_test.OutExtractor(fail=True)
+            ptr = tatami_python_test.WrappedMatrix(mat, cache_size, cache_size > 0, dense_extractor=ext, use_out=True)
+            if cache > 0 and mat.shape[0] and mat.shape[1] and not delayedarray.is_sparse(mat):
+                with pytest.raises(TypeError):
+                    ptr.dense_sum(True, False, 1)
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_chunk_extractor(subtests, mat):
+    for concatenate in [False, True]:
+        for cache in [0.01, 0.1]:
+            cache_size = compare.get_cache_size(mat, cache, True)
+
+            with subtests.test(msg="chunk extractor", concatenate=concatenate, cache=cache):
+                dext = tatami_python_test.ChunkExtractor(sparse=False, concatenate=concatenate)
+                sext = tatami_python_test.ChunkExtractor(sparse=True, concatenate=concatenate)
+                compare.check_sums(
+                    mat,
+                    dense=[(True, True, 1), (False, True, 1)],
+                    sparse=[(True, True, 3), (False, True, 3)],
+                    cache_size=cache_size,
+                    dense_chunk_extractor=dext,
+                    sparse_chunk_extractor=sext
+                )
+                if mat.shape[0] and mat.shape[1]:
+                    assert dext.num_calls + sext.num_calls > 0
+                    assert dext.num_ranges >= dext.num_calls
+
+            with subtests.test(msg="chunk extractor with executor", concatenate=concatenate, cache=cache):
+                dext = tatami_python_test.ChunkExtractor(sparse=False, concatenate=concatenate)
+                sext = tatami_python_test.ChunkExtractor(sparse=True, concatenate=concatenate)
+                with concurrent.futures.ThreadPoolExecutor(max_workers=2) as executor:
+                    compare.check_sums(
+                        mat,
+                        dense=[(True, True, 1)],
+                        sparse=[(False, True, 1)],
+                        cache_size=cache_size,
+                        dense_chunk_extractor=dext,
+                        sparse_chunk_extractor=sext,
+                        executor=executor,
+                        max_in_flight=3
+                    )
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_bounded_staging_buffers(subtests, mat):
+    for concatenate in [False, True]:
+        with subtests.test(msg="bounded staging buffers", concatenate=concatenate):
+            # Row extraction should never request more than one chunk's worth of rows in each call.
+            sext = tatami_python_test.ChunkExtractor(sparse=True, concatenate=concatenate)
+            ptr = compare.check_sums(
+                mat,
+                dense=[(True, True, 3)],
+                sparse=[(True, True, 1)],
+                maximum_staging_elements=1,
+                sparse_chunk_extractor=sext
+            )
+            ticks = ptr.chunk_ticks(True)
+            if len(ticks) > 1:
+                assert sext.max_length <= compare.max_chunk_length(ticks)
+
+            # No effect on column extraction.
+            compare.check_sums(mat, sparse=[(False, True, 1)], maximum_staging_elements=1, sparse_chunk_extractor=sext)
@@ -0,0 +1,100 @@
+import os
+import numpy
+import pytest
+import delayedarray
+import tatami_python_test
+import compare
+
+h5py = pytest.importorskip("h5py")
+
+
+# Generics for a local subclass of h5py.Dataset, so that the UnknownMatrix fallback can be used when the HDF5 fast path is not available.
+# Registering a subclass avoids changing the behavior of delayedarray's generics for h5py.Dataset in other tests.
+class LocalDataset(h5py.Dataset):
+    pass
+
+
+@delayedarray.is_sparse.register
+def is_sparse_LocalDataset(x: LocalDataset):
+    return False
+
+
+@delayedarray.extract_dense_array.register
+def extract_dense_array_from_LocalDataset(x: LocalDataset, indices):
+    rows = numpy.asarray(indices[0], dtype=numpy.int64)
+    cols = numpy.asarray(indices[1], dtype=numpy.int64)
+    if len(rows) == 0 or len(cols) == 0:
+        return numpy.zeros((len(rows), len(cols)), dtype=x.dtype)
+
+    # h5py only supports fancy indexing on one axis with sorted unique indices,
+    # so we read the requested rows within the span of the requested columns, and then index in memory.
+    unique_rows, row_inverse = numpy.unique(rows, return_inverse=True)
+    col_start = int(cols.min())
+    block = x[unique_rows, col_start:int(cols.max()) + 1]
+    return block[numpy.ix_(row_inverse, cols - col_start)]
+
+
+@delayedarray.chunk_grid.register
+def chunk_grid_from_LocalDataset(x: LocalDataset):
+    chunks = x.chunks
+    if chunks is None:
+        chunks = (1, x.shape[1])
+    row_ticks = delayedarray.RegularTicks(chunks[0], x.shape[0])
+    col_ticks = delayedarray.RegularTicks(chunks[1], x.shape[1])
+    return delayedarray.SimpleGrid((row_ticks, col_ticks), cost_factor=1)
+
+
+def test_hdf5_dense(subtests, tmp_path):
+    NR = 58
+    NC = 37
+    contents = numpy.random.rand(NR, NC)
+    path = os.path.join(tmp_path, "dense.h5")
+    with h5py.File(path, "w") as handle:
+        handle.create_dataset("foo", data=contents, chunks=(10, 7))
+        handle.create_dataset("bar", data=(contents * 100).astype(numpy.int32))
+
+    native = tatami_python_test.TranslatedMatrix.has_hdf5()
+    with h5py.File(path, "r") as handle:
+        for name in ["foo", "bar"]:
+            x = delayedarray.DelayedArray(LocalDataset(handle[name].id))
+            stats = compare.translate_test_suite(subtests, x, False)
+            if native:
+                assert stats == { "native_operations": 0, "native_seeds": 1, "unknown_leaves": 0 }
+            else:
+                assert stats == { "native_operations": 0, "native_seeds": 0, "unknown_leaves": 1 }
+
+            y = numpy.log1p(x[:, 5:30] * 2).T
+            stats = compare.translate_test_suite(subtests, y, False)
+            assert stats["unknown_leaves"] == int(not native)
+
+    # Falling back to Python for files that are open for writing.
+    with h5py.File(path, "r+") as handle:
+        x = delayedarray.DelayedArray(LocalDataset(handle["foo"].id))
+        stats = compare.translate_test_suite(subtests, x, False)
+        assert stats["unknown_leaves"] == 1
+
+
+def test_hdf5_sparse(subtests, tmp_path):
+    hdf5array = pytest.importorskip("hdf5array")
+    scipy = pytest.importorskip("scipy")
+
+    NR = 71
+    NC = 42
+    contents = scipy.sparse.random(NR, NC, 0.1, format="csc")
+    path = os.path.join(tmp_path, "sparse.h5")
+    with h5py.File(path, "w") as handle:
+        group = handle.create_group("csc")
+        group.create_dataset("data", data=contents.data)
+        group.create_dataset("indices", data=contents.indices)
+        group.create_dataset("indptr", data=contents.indptr)
+
+    native = tatami_python_test.TranslatedMatrix.has_hdf5()
+    seed = hdf5array.Hdf5CompressedSparseMatrixSeed(path, "csc", shape=(NR, NC), by_column=True)
+    x = delayedarray.DelayedArray(seed)
+    stats = compare.translate_test_suite(subtests, x, True)
+    assert stats["native_seeds"] == int(native)
+    assert stats["unknown_leaves"] == int(not native)
+
+    y = x[10:60, :] / 5
+    stats = compare.translate_test_suite(subtests, y, True)
+    assert stats["unknown_leaves"] == int(not native)
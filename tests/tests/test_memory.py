@@ -0,0 +1,133 @@
+import random
+import numpy
+import delayedarray
+import pytest
+import tatami_python_test
+import compare
+import simulate
+
+MATRICES = simulate.feature_matrices()
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_cache_budget(subtests, mat):
+    for row in [True, False]:
+        iterdim = mat.shape[1 - int(row)]
+        otherdim = mat.shape[int(row)]
+        iseq = numpy.array(list(range(iterdim)), dtype=numpy.dtype("int32"))
+        all_expected = compare.create_expected_dense(mat, row, iseq, None)
+        total = compare.get_cache_size(mat, 0.2, True)
+
+        with subtests.test(msg="shared cache budget", row=row):
+            budget = tatami_python_test.CacheBudget(total, 2)
+            ptr1 = tatami_python_test.WrappedMatrix(mat, require_cache=False, cache_budget=budget)
+            ptr2 = tatami_python_test.WrappedMatrix(mat, require_cache=False, cache_budget=budget)
+            compare.compare_list_of_vectors(ptr1.extract_dense(row, iseq, None), all_expected)
+            compare.compare_list_of_vectors(ptr2.extract_dense(row, iseq, None, oracle=True), all_expected)
+            extracted_sparse = ptr1.extract_sparse(row, iseq, None, needs_value=True, needs_index=True)
+            compare.compare_list_of_vectors(compare.fill_sparse(extracted_sparse, otherdim, None), all_expected)
+
+            # All reservations should be released once the extractors are destroyed.
+            stats = budget.statistics()
+            assert stats["reserved"] == 0
+            assert stats["active"] == 0
+            assert stats["peak_reserved"] <= stats["total"]
+
+        with subtests.test(msg="shared cache budget parallel", row=row):
+            budget = tatami_python_test.CacheBudget(total, 3)
+            compare.check_sums(mat, dense=[(row, False, 3), (row, True, 3)], require_cache=False, cache_budget=budget)
+            stats = budget.statistics()
+            assert stats["reserved"] == 0
+            assert stats["peak_reserved"] <= stats["total"]
+
+        with subtests.test(msg="shrunken cache budget", row=row):
+            # Bytes that can't be used for whole slabs should be returned to the budget.
+            max_chunk = compare.max_chunk_length(tatami_python_test.WrappedMatrix(mat).chunk_ticks(row))
+            slab = max_chunk * otherdim * 8
+            if slab and iterdim >= 3 * max_chunk:
+                budget = tatami_python_test.CacheBudget(slab * 2.5, 1)
+                ptr = tatami_python_test.WrappedMatrix(mat, require_cache=False, cache_budget=budget, sequential_read_ahead=False)
+                assert budget.reserved_by_extractor(ptr, row) == slab * 2
+                assert budget.statistics()["reserved"] == 0
+
+        with subtests.test(msg="exhausted cache budget", row=row):
+            # Falling back to a separate call for each row/column.
+            budget = tatami_python_test.CacheBudget(0)
+            ptr = tatami_python_test.WrappedMatrix(mat, require_cache=False, cache_budget=budget)
+            compare.compare_list_of_vectors(ptr.extract_dense(row, iseq, None), all_expected)
+            assert budget.statistics()["peak_reserved"] == 0
+
+        with subtests.test(msg="over-subscribed cache budget", row=row):
+            # More extractors than expected, each demanding a minimum cache that the budget cannot satisfy.
+            budget = tatami_python_test.CacheBudget(total, 1)
+            compare.check_sums(
+                mat,
+                dense=[(row, False, 3), (row, True, 3)],
+                require_cache=True,
+                cache_budget=budget,
+                minimum_batch_elements=otherdim * 10
+            )
+            stats = budget.statistics()
+            assert stats["reserved"] == 0
+            assert stats["peak_reserved"] <= stats["total"]
+
+            # A budget that is too small for a single chunk should not be exceeded to satisfy require_minimum_cache.
+            budget = tatami_python_test.CacheBudget(1, 1)
+            ptr = tatami_python_test.WrappedMatrix(mat, require_cache=True, cache_budget=budget)
+            compare.compare_list_of_vectors(ptr.extract_dense(row, iseq, None), all_expected)
+            assert budget.statistics()["peak_reserved"] <= 1
+
+            solo = tatami_python_test.WrappedMatrix(mat, 0, False)
+            compare.compare_list_of_vectors(solo.extract_dense(row, iseq, None), all_expected)
+            assert ptr.statistics()["peak_memory"] == solo.statistics()["peak_memory"]
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_memory_tracking(subtests, mat):
+    with subtests.test(msg="memory accounting"):
+        ptr = compare.check_sums(mat, dense=[(True, True, 1)], sparse=[(False, False, 3)])
+
+        # All memory should be released once the extractors are destroyed.
+        stats = ptr.statistics()
+        assert stats["current_memory"] == 0
+        if mat.shape[0] and mat.shape[1]:
+            assert stats["peak_memory"] > 0
+
+        ptr.reset_peak_memory()
+        assert ptr.statistics()["peak_memory"] == 0
+
+    with subtests.test(msg="memory limit"):
+        # Any limit below the size of the caches forces a separate call for each chunk.
+        dext = tatami_python_test.ChunkExtractor(sparse=False)
+        sext = tatami_python_test.ChunkExtractor(sparse=True)
+        ptr = compare.check_sums(
+            mat,
+            dense=[(True, True, 1), (False, True, 1)],
+            sparse=[(True, True, 3), (False, True, 3)],
+            memory_limit=1,
+            dense_chunk_extractor=dext,
+            sparse_chunk_extractor=sext
+        )
+        assert dext.num_ranges == dext.num_calls
+        assert sext.num_ranges == sext.num_calls
+        assert ptr.statistics()["current_memory"] == 0
+
+    for row in [True, False]:
+        with subtests.test(msg="read-ahead memory", row=row):
+            # The cache is split between the myopic and read-ahead caches, so the read-ahead core doesn't double the memory usage.
+            iterdim = mat.shape[1 - int(row)]
+            otherdim = mat.shape[int(row)]
+            half = iterdim // 2
+            iseq = list(range(half)) + [random.randrange(iterdim) for _ in range(5)] + list(range(half, iterdim)) if iterdim else []
+            iseq = numpy.array(iseq, dtype=numpy.dtype("int32"))
+            all_expected = compare.create_expected_dense(mat, row, iseq, None)
+
+            cache_size = int(compare.get_cache_size(mat, 0.2, False))
+            ptr = tatami_python_test.WrappedMatrix(mat, cache_size, False, sequential_read_ahead=True)
+            compare.compare_list_of_vectors(ptr.extract_dense(row, iseq, None), all_expected)
+
+            stats = ptr.statistics()
+            assert stats["current_memory"] == 0
+            if not delayedarray.is_sparse(mat):
+                # Both caches, plus the results of a batch that fills the read-ahead cache, plus the non-target indices.
+                assert stats["peak_memory"] <= cache_size + cache_size // 2 + 4 * otherdim
@@ -0,0 +1,120 @@
+import bisect
+import random
+import numpy
+import pytest
+import tatami_python_test
+import compare
+import simulate
+
+MATRICES = simulate.feature_matrices()
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_adaptive_granularity(subtests, mat):
+    for row in [True, False]:
+        iterdim = mat.shape[1 - int(row)]
+        otherdim = mat.shape[int(row)]
+
+        with subtests.test(msg="adaptive granularity", row=row):
+            # Many random accesses, so that we get multiple windows.
+            rng = random.Random(42)
+            iseq = numpy.array([rng.randrange(iterdim) for _ in range(500)] if iterdim else [], dtype=numpy.dtype("int32"))
+            all_expected = compare.create_expected_dense(mat, row, iseq, None)
+            cache_size = compare.get_cache_size(mat, 0.1, True)
+
+            ptr = tatami_python_test.WrappedMatrix(mat, cache_size, True, adaptive_granularity=True)
+            compare.compare_list_of_vectors(ptr.extract_dense(row, iseq, None), all_expected)
+            extracted_sparse = ptr.extract_sparse(row, iseq, None, needs_value=True, needs_index=True)
+            compare.compare_list_of_vectors(compare.fill_sparse(extracted_sparse, otherdim, None), all_expected)
+
+            stats = ptr.statistics()
+            assert stats["switches_to_chunk"] <= stats["switches_to_element"]
+            if stats["switches_to_element"] == 0:
+                assert stats["element_loads"] == 0
+
+        with subtests.test(msg="adaptive granularity alternating", row=row):
+            # Only one chunk in the cache, and each request hits a different chunk from the previous one,
+            # so every request loads a new chunk and the extractor should switch to element mode after the first window.
+            dptr = tatami_python_test.WrappedMatrix(mat, 0, True, adaptive_granularity=True, sequential_read_ahead=False)
+            sptr = tatami_python_test.WrappedMatrix(mat, 0, True, adaptive_granularity=True, sequential_read_ahead=False)
+            ticks = list(dptr.chunk_ticks(row))
+            num_chunks = len(ticks) - 1
+            iseq = numpy.array([ticks[k % num_chunks] for k in range(200)] if num_chunks > 0 else [], dtype=numpy.dtype("int32"))
+            all_expected = compare.create_expected_dense(mat, row, iseq, None)
+            compare.compare_list_of_vectors(dptr.extract_dense(row, iseq, None), all_expected)
+            extracted_sparse = sptr.extract_sparse(row, iseq, None, needs_value=True, needs_index=True)
+            compare.compare_list_of_vectors(compare.fill_sparse(extracted_sparse, otherdim, None), all_expected)
+
+            for ptr in [dptr, sptr]:
+                stats = ptr.statistics()
+                if otherdim and num_chunks > 1 and compare.max_chunk_length(ticks) > 1:
+                    assert stats["switches_to_element"] == 1
+                    assert stats["switches_to_chunk"] == 0
+                    assert stats["element_loads"] > 0
+                else:
+                    assert stats["switches_to_element"] == 0
+
+        with subtests.test(msg="adaptive granularity consecutive", row=row):
+            # Consecutive access should stick with whole chunks, as long as each chunk has at least two elements.
+            iseq = numpy.array(list(range(iterdim)), dtype=numpy.dtype("int32"))
+            all_expected = compare.create_expected_dense(mat, row, iseq, None)
+            ptr = tatami_python_test.WrappedMatrix(mat, adaptive_granularity=True)
+            compare.compare_list_of_vectors(ptr.extract_dense(row, iseq, None), all_expected)
+            ticks = ptr.chunk_ticks(row)
+            if all(ticks[i] - ticks[i - 1] >= 2 for i in range(1, len(ticks))):
+                stats = ptr.statistics()
+                assert stats["switches_to_element"] == 0
+                assert stats["element_loads"] == 0
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_sequential_read_ahead(subtests, mat):
+    for row in [True, False]:
+        iterdim = mat.shape[1 - int(row)]
+        otherdim = mat.shape[int(row)]
+
+        patterns = {
+            "forward": list(range(iterdim)),
+            "reverse": list(range(iterdim - 1, -1, -1)),
+            "strided": list(range(0, iterdim, 3)),
+            # Breaking the sequence partway through, to check that we revert to myopic extraction.
+            "broken": list(range(iterdim // 2)) + [random.randrange(iterdim) for _ in range(10)] + list(range(iterdim // 2, iterdim)) if iterdim else [],
+        }
+
+        for name, pattern in patterns.items():
+            with subtests.test(msg="sequential read-ahead", row=row, pattern=name):
+                iseq = numpy.array(pattern, dtype=numpy.dtype("int32"))
+                all_expected = compare.create_expected_dense(mat, row, iseq, None)
+                cache_size = compare.get_cache_size(mat, 0.1, True)
+
+                ptr = tatami_python_test.WrappedMatrix(mat, cache_size, True, sequential_read_ahead=True)
+                compare.compare_list_of_vectors(ptr.extract_dense(row, iseq, None), all_expected)
+                extracted_sparse = ptr.extract_sparse(row, iseq, None, needs_value=True, needs_index=True)
+                compare.compare_list_of_vectors(compare.fill_sparse(extracted_sparse, otherdim, None), all_expected)
+
+                block_start = otherdim // 4
+                block_length = otherdim // 2
+                extracted_block = ptr.extract_dense(row, iseq, (block_start, block_length))
+                compare.compare_list_of_vectors(extracted_block, [x[block_start:block_start + block_length] for x in all_expected])
+
+                off = tatami_python_test.WrappedMatrix(mat, cache_size, True, sequential_read_ahead=False)
+                compare.compare_list_of_vectors(off.extract_dense(row, iseq, None), all_expected)
+                assert off.statistics()["switches_to_read_ahead"] == 0
+
+        with subtests.test(msg="sequential read-ahead statistics", row=row):
+            iseq = numpy.array(list(range(iterdim)), dtype=numpy.dtype("int32"))
+            ptr = tatami_python_test.WrappedMatrix(mat, sequential_read_ahead=True)
+            ptr.extract_dense(row, iseq, None)
+            stats = ptr.statistics()
+            ticks = ptr.chunk_ticks(row)
+            max_chunk = compare.max_chunk_length(ticks)
+            chunk_of = lambda i : bisect.bisect_right(ticks, i) - 1
+            # Each half of the cache needs at least two slabs, and the switch is deferred while the sequence is still in the chunk in the myopic cache.
+            if max_chunk and iterdim // max_chunk >= 4 and iterdim > 4 and (chunk_of(4) != chunk_of(3) or chunk_of(iterdim - 1) != chunk_of(4)):
+                assert stats["switches_to_read_ahead"] == 1
+            else:
+                assert stats["switches_to_read_ahead"] == 0
+
+            # No chunk should be fetched twice, i.e., when switching to read-ahead or when renewing its predictions.
+            if otherdim > 0:
+                assert stats["chunk_loads"] == len(ticks) - 1
@@ -0,0 +1,85 @@
+import numpy
+import pytest
+import delayedarray
+import tatami_python_test
+import simulate
+
+
+def check_proportion(wrapped):
+    prop = wrapped.prefer_rows_proportion()
+    assert prop >= 0 and prop <= 1
+    assert wrapped.prefer_rows() == (prop >= 0.5)
+    return prop
+
+
+def test_orientation_simple():
+    mat = numpy.random.rand(34, 82)
+    wrapped = tatami_python_test.WrappedMatrix(mat)
+    assert check_proportion(wrapped) > 0.5
+
+
+def test_orientation_regular():
+    mat = simulate.RegularChunkedArray(numpy.random.rand(54, 92), (10, 10))
+    wrapped = tatami_python_test.WrappedMatrix(mat)
+    assert check_proportion(wrapped) < 0.5
+
+    mat = simulate.RegularChunkedArray(numpy.random.rand(154, 32), (10, 10))
+    wrapped = tatami_python_test.WrappedMatrix(mat)
+    assert check_proportion(wrapped) > 0.5
+
+    # Square chunks on a square matrix have no preference.
+    mat = simulate.RegularChunkedArray(numpy.random.rand(50, 50), (10, 10))
+    wrapped = tatami_python_test.WrappedMatrix(mat)
+    assert wrapped.prefer_rows()
+    assert wrapped.prefer_rows_proportion() == 0.5
+
+
+def test_orientation_irregular():
+    # One huge row chunk and many small ones, such that there are more row chunks than column chunks.
+    # Nonetheless, most rows require the extraction of the huge chunk, so columns are cheaper to fetch.
+    NR = 100
+    NC = 100
+    row_ticks = [90] + list(range(91, NR + 1))
+    col_ticks = list(range(10, NC + 1, 10))
+    mat = simulate.IrregularChunkedArray(numpy.random.rand(NR, NC), (row_ticks, col_ticks))
+
+    wrapped = tatami_python_test.WrappedMatrix(mat)
+    assert not wrapped.prefer_rows()
+    assert check_proportion(wrapped) < 0.5
+
+    # Same for the transposed matrix.
+    mat = simulate.IrregularChunkedArray(numpy.random.rand(NC, NR), (col_ticks, row_ticks))
+    wrapped = tatami_python_test.WrappedMatrix(mat)
+    assert wrapped.prefer_rows()
+    assert check_proportion(wrapped) > 0.5
+
+
+def test_orientation_sparse():
+    mat = simulate.RegularChunkedArray(simulate.simulate_sparse(64, 102), (10, 10))
+    wrapped = tatami_python_test.WrappedMatrix(mat)
+    assert wrapped.is_sparse()
+    assert check_proportion(wrapped) < 0.5
+
+    # Each row requires parsing one SparseNdarray leaf per column, so columns are preferred for square chunks.
+    mat = simulate.RegularChunkedArray(simulate.simulate_sparse(50, 50), (10, 10))
+    wrapped = tatami_python_test.WrappedMatrix(mat)
+    assert not wrapped.prefer_rows()
+    assert check_proportion(wrapped) < 0.5
+
+
+def test_orientation_probe():
+    mat = simulate.RegularChunkedArray(numpy.random.rand(54, 92), (10, 10))
+    wrapped = tatami_python_test.WrappedMatrix(mat, probe_orientation=True)
+    prop = check_proportion(wrapped)
+    assert prop > 0 and prop < 1
+
+    # Probing an empty matrix is a no-op.
+    mat = numpy.zeros((0, 10))
+    wrapped = tatami_python_test.WrappedMatrix(mat, probe_orientation=True)
+    check_proportion(wrapped)
+
+    # Probing is not allowed with an event loop, as it would block on the loop.
+    mat = simulate.RegularChunkedArray(numpy.random.rand(54, 92), (10, 10))
+    with tatami_python_test.EventLoopThread() as runner:
+        with pytest.raises(RuntimeError, match="event_loop"):
+            tatami_python_test.WrappedMatrix(mat, probe_orientation=True, event_loop=runner.loop)
@@ -0,0 +1,46 @@
+import numpy
+import pytest
+import tatami_python_test
+import compare
+import simulate
+
+MATRICES = simulate.feature_matrices()
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_partition(subtests, mat):
+    refs = compare.reference_sums(mat)
+
+    for row in [True, False]:
+        with subtests.test(msg="partition", row=row):
+            ptr = tatami_python_test.WrappedMatrix(mat)
+            ticks = list(ptr.chunk_ticks(row))
+            assert ticks[0] == 0
+            assert ticks[-1] == mat.shape[1 - int(row)]
+
+            for threads in [1, 2, 3, 7]:
+                bounds = list(ptr.partition(row, threads))
+                if len(ticks) == 1:
+                    assert bounds == []
+                    continue
+                assert bounds[0] == 0
+                assert bounds[-1] == ticks[-1]
+                assert len(bounds) <= threads + 1
+                for b in bounds:
+                    assert b in ticks
+                for i in range(1, len(bounds)):
+                    assert bounds[i] > bounds[i - 1]
+
+            # All the cost is in the first chunk, so it should be in a range by itself.
+            if len(ticks) > 2:
+                costs = [0] * (len(ticks) - 1)
+                costs[0] = 100
+                costs[-1] = 1
+                bounds = list(ptr.partition(row, 2, costs))
+                assert bounds == [0, ticks[1], ticks[-1]]
+
+        for stealing in [False, True]:
+            with subtests.test(msg="aligned sums", row=row, stealing=stealing):
+                ptr = tatami_python_test.WrappedMatrix(mat)
+                assert numpy.allclose(refs[int(row)], ptr.aligned_dense_sum(row, 1, stealing=stealing))
+                assert numpy.allclose(refs[int(row)], ptr.aligned_dense_sum(row, 3, stealing=stealing))
@@ -84,3 +84,23 @@ def test_Sparse2darray_empty(subtests):
 
     mat = delayedarray.SparseNdarray((0, 10), None, dtype=numpy.dtype("double"), index_dtype=numpy.dtype("int32"))
     compare.big_test_suite(subtests, mat)
+
+
+def test_Sparse2darray_narrow_cached_index(subtests):
+    # Block and indexed extraction with original indices that do not fit in the cached index type.
+    NR = 40
+    NC = 700
+    mat = simulate.simulate_sparse(NR, NC, density = 0.3)
+    wrapped = tatami_python_test.WrappedMatrix(mat, narrow_cached_index=True)
+    iseq = numpy.array(list(range(NR)), dtype=numpy.dtype("int32"))
+
+    for oracle in [False, True]:
+        for subset in [(10, 200), (400, 250), [5, 250, 256, 300, 699]]:
+            with subtests.test(msg="narrow cached index", oracle=oracle, subset=subset):
+                if isinstance(subset, tuple):
+                    keep = list(range(subset[0], subset[0] + subset[1]))
+                else:
+                    keep = subset
+                expected = compare.create_expected_dense(mat, True, iseq, keep)
+                extracted = wrapped.extract_sparse(True, iseq, subset, oracle=oracle, needs_value=True, needs_index=True)
+                compare.compare_list_of_vectors(compare.fill_sparse(extracted, NC, keep), expected)
@@ -0,0 +1,66 @@
+import numpy
+import tatami_python_test
+import compare
+import simulate
+
+
+def reference_lookup(ticks):
+    return numpy.searchsorted(ticks, numpy.arange(ticks[-1]), side="right") - 1
+
+
+def test_chunk_lookup_regular():
+    regular, ids = tatami_python_test.chunk_lookup([0, 10, 20, 30])
+    assert regular
+    assert (ids == numpy.arange(30) // 10).all()
+
+    # A single chunk is trivially regular.
+    regular, ids = tatami_python_test.chunk_lookup([0, 7])
+    assert regular
+    assert (ids == 0).all()
+
+    # An empty dimension has no chunks to look up.
+    regular, ids = tatami_python_test.chunk_lookup([0])
+    assert len(ids) == 0
+
+
+def test_chunk_lookup_short_last():
+    # A short last chunk still uses the regular division.
+    ticks = [0, 10, 20, 25]
+    regular, ids = tatami_python_test.chunk_lookup(ticks)
+    assert regular
+    assert (ids == reference_lookup(ticks)).all()
+    assert ids[-1] == 2
+
+    ticks = [0, 10, 11]
+    regular, ids = tatami_python_test.chunk_lookup(ticks)
+    assert regular
+    assert (ids == reference_lookup(ticks)).all()
+
+    # But a long last chunk does not.
+    ticks = [0, 10, 20, 35]
+    regular, ids = tatami_python_test.chunk_lookup(ticks)
+    assert not regular
+    assert (ids == reference_lookup(ticks)).all()
+
+
+def test_chunk_lookup_irregular():
+    for ticks in [[0, 3, 10, 11, 30], [0, 1, 2, 50], [0, 20, 21, 22, 23, 40]]:
+        regular, ids = tatami_python_test.chunk_lookup(ticks)
+        assert not regular
+        assert (ids == reference_lookup(ticks)).all()
+
+    # A short first chunk is not regular, even if all later chunks are the same length.
+    ticks = [0, 5, 15, 25]
+    regular, ids = tatami_python_test.chunk_lookup(ticks)
+    assert not regular
+    assert (ids == reference_lookup(ticks)).all()
+
+
+def test_chunk_lookup_extraction(subtests):
+    # Extraction through UnknownMatrix with a short last chunk in both dimensions.
+    mat = simulate.RegularChunkedArray(numpy.random.rand(43, 27), (10, 6))
+    compare.full_test_suite(subtests, mat)
+
+    # Extraction with irregular chunks in both dimensions.
+    mat = simulate.IrregularChunkedArray(numpy.random.rand(43, 27), ([3, 10, 11, 30, 43], [1, 2, 20, 27]))
+    compare.full_test_suite(subtests, mat)
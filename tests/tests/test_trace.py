@@ -0,0 +1,97 @@
+import os
+import tempfile
+import numpy
+import pytest
+import tatami_python_test
+import compare
+import simulate
+
+MATRICES = simulate.feature_matrices()
+
+
+def replay_trace(ptr, advisor):
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "trace.csv")
+        ptr.write_access_trace(path)
+        return advisor.read_trace(path)
+
+
+@pytest.mark.parametrize("mat", MATRICES.values(), ids=MATRICES.keys())
+def test_access_trace(subtests, mat):
+    advisor = compare.load_cache_advisor()
+
+    for row in [True, False]:
+        iterdim = mat.shape[1 - int(row)]
+        otherdim = mat.shape[int(row)]
+
+        with subtests.test(msg="access trace", row=row):
+            iseq = numpy.array(list(range(iterdim)) * 2, dtype=numpy.dtype("int32"))
+            ptr = tatami_python_test.WrappedMatrix(mat, record_trace=True, sequential_read_ahead=False)
+            all_expected = compare.create_expected_dense(mat, row, iseq, None)
+            compare.compare_list_of_vectors(ptr.extract_dense(row, iseq, None), all_expected)
+
+            trace = ptr.access_trace()
+            assert len(trace["chunk"]) == len(iseq)
+            assert all(r == row for r in trace["row"])
+            assert len(set(trace["extractor"])) <= 1
+            assert not any(trace["read_ahead"])
+
+            # Densified sparse extraction caches both the values and indices.
+            itemsize = 12 if ptr.is_sparse() else 8
+            ticks = ptr.chunk_ticks(row)
+            for i, c, b in zip(iseq, trace["chunk"], trace["bytes"]):
+                assert ticks[c] <= i and i < ticks[c + 1]
+                assert b == (ticks[c + 1] - ticks[c]) * otherdim * itemsize
+
+            replay = replay_trace(ptr, advisor)
+            assert sum(len(t) for t in replay.values()) == len(iseq)
+
+            num_chunks = len(ticks) - 1
+            for res in advisor.advise(replay):
+                assert 0 <= res["belady_miss_rate"] and res["belady_miss_rate"] <= 1
+                assert 0 <= res["lru_miss_rate"] and res["lru_miss_rate"] <= 1
+            if len(iseq):
+                single = list(replay.values())[0]
+                distinct = {}
+                for key, size in single:
+                    distinct[key] = size
+                big = sum(distinct.values())
+                assert advisor.simulate_lru(single, big)[0] == num_chunks
+                assert advisor.simulate_belady(single, big)[0] == num_chunks
+
+            ptr.clear_access_trace()
+            assert len(ptr.access_trace()["chunk"]) == 0
+
+        with subtests.test(msg="access trace per extractor", row=row):
+            # Each extractor has its own cache, so the same chunks must be loaded again by a second extractor.
+            iseq = numpy.array(list(range(iterdim)), dtype=numpy.dtype("int32"))
+            ptr = tatami_python_test.WrappedMatrix(mat, record_trace=True, sequential_read_ahead=False)
+            ptr.extract_dense(row, iseq, None)
+            ptr.extract_dense(row, iseq, None)
+            trace = ptr.access_trace()
+            assert len(trace["chunk"]) == 2 * len(iseq)
+            if len(iseq):
+                assert len(set(trace["extractor"])) == 2
+
+            replay = replay_trace(ptr, advisor)
+            num_chunks = len(ptr.chunk_ticks(row)) - 1
+            for res in advisor.advise(replay):
+                if res["budget"] == max(advisor.default_budgets(replay)):
+                    assert res["lru_calls"] == 2 * num_chunks
+
+        with subtests.test(msg="access trace read-ahead", row=row):
+            # Consecutive access by a myopic extractor switches to read-ahead, which is recorded under the same extractor with a positive read-ahead index.
+            iseq = numpy.array(list(range(iterdim)), dtype=numpy.dtype("int32"))
+            ptr = tatami_python_test.WrappedMatrix(mat, record_trace=True, sequential_read_ahead=True)
+            ptr.extract_dense(row, iseq, None)
+            trace = ptr.access_trace()
+            assert len(set(trace["extractor"])) <= 1
+            if ptr.statistics()["switches_to_read_ahead"] > 0:
+                assert any(trace["read_ahead"])
+                assert not trace["read_ahead"][0]
+                assert min(x for x in trace["read_ahead"] if x) == 1
+
+        with subtests.test(msg="access trace disabled", row=row):
+            ptr = tatami_python_test.WrappedMatrix(mat)
+            ptr.extract_dense(row, list(range(iterdim)), None)
+            assert len(ptr.access_trace()["chunk"]) == 0
@@ -0,0 +1,122 @@
+import numpy
+import delayedarray
+import tatami_python_test
+import compare
+import simulate
+
+
+def test_translate_dense(subtests):
+    NR = 45
+    NC = 33
+    x = delayedarray.DelayedArray(numpy.random.rand(NR, NC))
+    stats = compare.translate_test_suite(subtests, x, False)
+    assert stats == { "native_operations": 0, "native_seeds": 1, "unknown_leaves": 0 }
+
+    # Scalar and vector arithmetic, subsetting, transposition and log1p.
+    y = numpy.log1p(x[5:40, [1, 3, 5, 7, 2, 4, 6, 8, 20, 30]] * 2 + 1)
+    y = (y / numpy.random.rand(10) + 1).T
+    y = 1 - y
+    stats = compare.translate_test_suite(subtests, y, False)
+    assert stats["unknown_leaves"] == 0
+    assert stats["native_seeds"] == 1
+    assert stats["native_operations"] >= 7
+
+    # Along the other dimension.
+    z = x - numpy.random.rand(NR).reshape(NR, 1)
+    stats = compare.translate_test_suite(subtests, z, False)
+    assert stats["unknown_leaves"] == 0
+
+    # Combining by rows and columns.
+    other = delayedarray.DelayedArray(numpy.random.rand(10, NC))
+    stats = compare.translate_test_suite(subtests, numpy.concatenate((x, other * 5)), False)
+    assert stats["unknown_leaves"] == 0
+    assert stats["native_seeds"] == 2
+
+    other = delayedarray.DelayedArray(numpy.asfortranarray(numpy.random.rand(NR, 12)))
+    stats = compare.translate_test_suite(subtests, numpy.concatenate((other, x), axis=1), False)
+    assert stats["unknown_leaves"] == 0
+
+
+def test_translate_dense_view():
+    NR = 20
+    NC = 15
+    x = numpy.random.rand(NR, NC)
+    ptr = tatami_python_test.TranslatedMatrix(delayedarray.DelayedArray(x))
+    iseq = list(range(NR))
+
+    # No copy is made for a contiguous array of the cached type, so changes are visible.
+    x[:] = 0
+    extracted = ptr.extract_dense(True, iseq, None, False)
+    assert all((vec == 0).all() for vec in extracted)
+
+    # Matrix holds a reference to the array.
+    del x
+    extracted = ptr.extract_dense(True, iseq, None, False)
+    assert all((vec == 0).all() for vec in extracted)
+
+    # Arrays of other types are converted first, so changes are not visible.
+    y = numpy.ones((NR, NC), dtype=numpy.int32)
+    ptr = tatami_python_test.TranslatedMatrix(delayedarray.DelayedArray(y))
+    y[:] = 0
+    extracted = ptr.extract_dense(True, iseq, None, False)
+    assert all((vec == 1).all() for vec in extracted)
+
+
+def test_translate_arithmetic(subtests):
+    NR = 23
+    NC = 19
+    x = delayedarray.DelayedArray(numpy.random.rand(NR, NC) + 0.5)
+    rowvec = numpy.random.rand(NR).reshape(NR, 1) + 0.5
+    colvec = numpy.random.rand(NC) + 0.5
+
+    # Each operation is created by delayedarray's operator overloads, to check that its operation names are recognized.
+    ops = {
+        "add": [x + 1, 1 + x, x + colvec],
+        "subtract": [x - 1, 1 - x, rowvec - x],
+        "multiply": [x * 2, 2 * x, x * rowvec],
+        "divide": [x / 3, 3 / x, x / colvec, colvec / x],
+        "power": [x ** 2, 2 ** x, x ** rowvec],
+        "remainder": [x % 0.3, 2 % x, x % colvec],
+        "floor_divide": [x // 0.3, 2 // x, rowvec // x],
+    }
+
+    for name, ys in ops.items():
+        for i, y in enumerate(ys):
+            with subtests.test(msg="arithmetic", operation=name, case=i):
+                stats = compare.translate_test_suite(subtests, y, False)
+                assert stats == { "native_operations": 1, "native_seeds": 1, "unknown_leaves": 0 }
+
+
+def test_translate_sparse(subtests):
+    NR = 52
+    NC = 41
+    x = delayedarray.DelayedArray(simulate.simulate_sparse(NR, NC, empty=0.2))
+    stats = compare.translate_test_suite(subtests, x, True)
+    assert stats == { "native_operations": 0, "native_seeds": 1, "unknown_leaves": 0 }
+
+    y = numpy.log1p(x[:, 1:30] * 10).T / 2
+    stats = compare.translate_test_suite(subtests, y, True)
+    assert stats["unknown_leaves"] == 0
+    assert stats["native_seeds"] == 1
+
+
+def test_translate_unsupported(subtests):
+    NR = 37
+    NC = 29
+
+    # Unsupported seeds are wrapped in an UnknownMatrix, but the operations on top are still native.
+    mat = simulate.RegularChunkedArray(numpy.random.rand(NR, NC), (10, 10))
+    x = delayedarray.DelayedArray(mat)
+    y = numpy.log1p(x * 2)
+    stats = compare.translate_test_suite(subtests, y, False)
+    assert stats == { "native_operations": 2, "native_seeds": 0, "unknown_leaves": 1 }
+
+    # Unsupported operations are evaluated in Python, along with their seeds.
+    x = delayedarray.DelayedArray(numpy.random.rand(NR, NC))
+    y = numpy.sqrt(x)[:, 0:10] + 1
+    stats = compare.translate_test_suite(subtests, y, False)
+    assert stats == { "native_operations": 2, "native_seeds": 0, "unknown_leaves": 1 }
+
+    y = (x > 0.5) * 1.0
+    stats = compare.translate_test_suite(subtests, y, False)
+    assert stats["unknown_leaves"] == 1
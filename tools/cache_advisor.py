@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""Replay a chunk access trace against a range of cache sizes.
+
+The trace should be a CSV file with the ``extractor``, ``read_ahead``,
+``row``, ``chunk`` and ``bytes`` columns, one line per access, as written by
+``tatami_python::write_access_trace()`` from the output of
+``tatami_python::UnknownMatrix::access_trace()`` with
+``UnknownMatrixOptions::record_trace = true``. Each extractor has its own
+cache, and each read-ahead cache of a myopic extractor is separate from its
+usual cache, so the accesses for each cache are replayed separately; the
+budget applies to each cache. For each budget, this reports the miss rate and
+number of Python calls for a least-recently-used cache (the default
+``UnknownMatrixOptions::cache_policy`` for myopic extractors) and for
+Belady's optimal policy (approximating the oracle-aware extractors, which
+evict slabs based on the upcoming predictions), summed across all caches. The knee of the curve is a good choice for
+``maximum_cache_size``, after doubling it if read-ahead is enabled, as each
+myopic extractor then splits its cache evenly between its two caches.
+
+Usage::
+
+    python3 cache_advisor.py trace.csv [--budgets 1e6 1e7 1e8]
+
+This only requires the Python standard library.
+"""
+
+import argparse
+import collections
+import csv
+import heapq
+
+
+def _parse_bool(x):
+    return x.strip().lower() in ("1", "true")
+
+
+def _parse_read_ahead(x):
+    # Older traces only reported whether the access was made in read-ahead mode.
+    x = x.strip().lower()
+    if x in ("true", "false"):
+        return int(x == "true")
+    return int(x)
+
+
+def read_trace(path):
+    """Read a trace from a CSV file, splitting it by the cache that served each
+    access. Returns a dictionary where each key is an ``(extractor,
+    read_ahead)`` tuple identifying a cache, where ``read_ahead`` is zero for
+    the usual cache of the extractor and otherwise indexes the read-ahead
+    caches that it created over time. Each value is a list of
+    ``(key, bytes)`` tuples for the accesses to that cache in order, where
+    ``key`` is a ``(row, chunk)`` tuple. Traces without the ``extractor`` and
+    ``read_ahead`` columns are assumed to come from a single cache.
+    """
+    traces = {}
+    with open(path, newline="") as handle:
+        for line in csv.DictReader(handle):
+            cache = (int(line.get("extractor", 0)), _parse_read_ahead(line.get("read_ahead", "0")))
+            key = (_parse_bool(line["row"]), int(line["chunk"]))
+            if cache not in traces:
+                traces[cache] = []
+            traces[cache].append((key, int(line["bytes"])))
+    return traces
+
+
+def simulate_lru(trace, budget):
+    """Simulate a least-recently-used cache with a byte budget.
+
+    Returns a tuple containing the number of misses and the number of Python
+    calls, which are the same as each miss is loaded separately.
+    """
+    cache = collections.OrderedDict()
+    used = 0
+    misses = 0
+    for key, size in trace:
+        if key in cache:
+            cache.move_to_end(key)
+            continue
+        misses += 1
+        if size > budget:
+            continue
+        while used + size > budget:
+            _, evicted = cache.popitem(last=False)
+            used -= evicted
+        cache[key] = size
+        used += size
+    return misses, misses
+
+
+def simulate_belady(trace, budget):
+    """Simulate Belady's optimal policy with a byte budget, i.e., evicting the
+    chunk that is next used furthest in the future. For variable chunk sizes,
+    this is a (good) heuristic rather than the exact optimum.
+
+    Returns a tuple containing the number of misses and the number of Python
+    calls. Each call is assumed to load the missing chunk along with the
+    next few chunks that will be missed, as long as they fit in the space
+    that is not used by cached chunks that will be needed again; this mimics
+    the batching in the oracle-aware extractors.
+    """
+    num = len(trace)
+    next_use = [num] * num
+    last_seen = {}
+    for i in range(num - 1, -1, -1):
+        key = trace[i][0]
+        next_use[i] = last_seen.get(key, num)
+        last_seen[key] = i
+
+    cache = {}
+    heap = []
+    used = 0
+    misses = 0
+    calls = 0
+    pending = set()
+    for i, (key, size) in enumerate(trace):
+        if key in cache:
+            cache[key] = (next_use[i], size)
+            heapq.heappush(heap, (-next_use[i], key))
+            continue
+
+        misses += 1
+        if key in pending:
+            # Already loaded as part of a previous call.
+            pending.remove(key)
+        else:
+            calls += 1
+            pending.clear()
+            # Cached chunks that are used again are retained, so the batch can only use the rest of the budget.
+            batch = size + sum(sz for nu, sz in cache.values() if nu < num)
+            for j in range(i + 1, num):
+                upcoming, upsize = trace[j]
+                if upcoming in cache or upcoming in pending or upcoming == key:
+                    continue
+                if batch + upsize > budget:
+                    break
+                pending.add(upcoming)
+                batch += upsize
+        if size > budget or next_use[i] == num:
+            continue
+
+        while used + size > budget:
+            # Skipping stale heap entries for chunks that were evicted or used again since the entry was pushed.
+            nu, victim = heapq.heappop(heap)
+            if victim in cache and cache[victim][0] == -nu:
+                used -= cache[victim][1]
+                del cache[victim]
+
+        cache[key] = (next_use[i], size)
+        heapq.heappush(heap, (-next_use[i], key))
+        used += size
+
+    return misses, calls
+
+
+def default_budgets(traces, num = 10):
+    """Choose a geometric sequence of budgets from the largest chunk to the
+    total size of all distinct chunks in any single cache.
+    """
+    lower = 0
+    upper = 0
+    for trace in traces.values():
+        sizes = {}
+        for key, size in trace:
+            sizes[key] = size
+        if sizes:
+            lower = max(lower, max(sizes.values()))
+            upper = max(upper, sum(sizes.values()))
+    if lower == 0:
+        return []
+    upper = max(upper, lower)
+    if num <= 1 or upper == lower:
+        return [upper]
+    ratio = (upper / lower) ** (1 / (num - 1))
+    return sorted(set(int(lower * ratio ** i) for i in range(num - 1)) | { upper })
+
+
+def advise(traces, budgets = None):
+    """Replay the trace for each cache (as returned by ``read_trace()``)
+    against each budget, returning a list of dictionaries with the budget and
+    the miss rates and call counts for each policy, summed across caches.
+    """
+    if budgets is None:
+        budgets = default_budgets(traces)
+    total = sum(len(trace) for trace in traces.values())
+    output = []
+    for b in budgets:
+        lru_misses = lru_calls = opt_misses = opt_calls = 0
+        for trace in traces.values():
+            misses, calls = simulate_lru(trace, b)
+            lru_misses += misses
+            lru_calls += calls
+            misses, calls = simulate_belady(trace, b)
+            opt_misses += misses
+            opt_calls += calls
+        output.append({
+            "budget": b,
+            "lru_miss_rate": lru_misses / total if total else 0,
+            "lru_calls": lru_calls,
+            "belady_miss_rate": opt_misses / total if total else 0,
+            "belady_calls": opt_calls,
+        })
+    return output
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replay a chunk access trace against a range of cache sizes.")
+    parser.add_argument("trace", help="CSV file with the extractor, read_ahead, row, chunk and bytes columns.")
+    parser.add_argument("--budgets", type=float, nargs="+", help="Cache sizes in bytes. Defaults to a geometric sequence.")
+    args = parser.parse_args()
+
+    traces = read_trace(args.trace)
+    budgets = None if args.budgets is None else [int(b) for b in args.budgets]
+    print("budget\tlru_miss_rate\tlru_calls\tbelady_miss_rate\tbelady_calls")
+    for res in advise(traces, budgets):
+        print("{}\t{:.4f}\t{}\t{:.4f}\t{}".format(res["budget"], res["lru_miss_rate"], res["lru_calls"], res["belady_miss_rate"], res["belady_calls"]))
+
+
+if __name__ == "__main__":
+    main()